@@ -71,7 +71,8 @@ $(shell cp -f $(LOCAL_PATH)/../common/JackTransportEngine.cpp       $(LOCAL_PATH
 $(shell cp -f $(LOCAL_PATH)/../common/timestamps.c                  $(LOCAL_PATH)/$(common_libsource_server_dir)/timestamps.c)
 $(shell cp -f $(LOCAL_PATH)/../common/JackTools.cpp                 $(LOCAL_PATH)/$(common_libsource_server_dir)/JackTools.cpp)
 $(shell cp -f $(LOCAL_PATH)/../common/JackMessageBuffer.cpp         $(LOCAL_PATH)/$(common_libsource_server_dir)/JackMessageBuffer.cpp)
-$(shell cp -f $(LOCAL_PATH)/../common/JackEngineProfiling.cpp       $(LOCAL_PATH)/$(common_libsource_server_dir)/JackEngineProfiling.cpp)
+$(shell cp -f $(LOCAL_PATH)/../common/JackEngineTrace.cpp           $(LOCAL_PATH)/$(common_libsource_server_dir)/JackEngineTrace.cpp)
+$(shell cp -f $(LOCAL_PATH)/../common/JackTimingStats.cpp           $(LOCAL_PATH)/$(common_libsource_server_dir)/JackTimingStats.cpp)
 $(shell cp -f $(LOCAL_PATH)/JackAndroidThread.cpp                   $(LOCAL_PATH)/$(common_libsource_server_dir)/JackAndroidThread.cpp)
 $(shell cp -f $(LOCAL_PATH)/JackAndroidSemaphore.cpp                $(LOCAL_PATH)/$(common_libsource_server_dir)/JackAndroidSemaphore.cpp)
 $(shell cp -f $(LOCAL_PATH)/../posix/JackPosixProcessSync.cpp       $(LOCAL_PATH)/$(common_libsource_server_dir)/JackPosixProcessSync.cpp)
@@ -102,7 +103,8 @@ $(shell cp -f $(LOCAL_PATH)/../common/JackTransportEngine.cpp       $(LOCAL_PATH
 $(shell cp -f $(LOCAL_PATH)/../common/timestamps.c                  $(LOCAL_PATH)/$(common_libsource_client_dir)/timestamps.c)
 $(shell cp -f $(LOCAL_PATH)/../common/JackTools.cpp                 $(LOCAL_PATH)/$(common_libsource_client_dir)/JackTools.cpp)
 $(shell cp -f $(LOCAL_PATH)/../common/JackMessageBuffer.cpp         $(LOCAL_PATH)/$(common_libsource_client_dir)/JackMessageBuffer.cpp)
-$(shell cp -f $(LOCAL_PATH)/../common/JackEngineProfiling.cpp       $(LOCAL_PATH)/$(common_libsource_client_dir)/JackEngineProfiling.cpp)
+$(shell cp -f $(LOCAL_PATH)/../common/JackEngineTrace.cpp           $(LOCAL_PATH)/$(common_libsource_client_dir)/JackEngineTrace.cpp)
+$(shell cp -f $(LOCAL_PATH)/../common/JackTimingStats.cpp           $(LOCAL_PATH)/$(common_libsource_client_dir)/JackTimingStats.cpp)
 $(shell cp -f $(LOCAL_PATH)/JackAndroidThread.cpp                   $(LOCAL_PATH)/$(common_libsource_client_dir)/JackAndroidThread.cpp)
 $(shell cp -f $(LOCAL_PATH)/JackAndroidSemaphore.cpp                $(LOCAL_PATH)/$(common_libsource_client_dir)/JackAndroidSemaphore.cpp)
 $(shell cp -f $(LOCAL_PATH)/../posix/JackPosixProcessSync.cpp       $(LOCAL_PATH)/$(common_libsource_client_dir)/JackPosixProcessSync.cpp)
@@ -134,7 +136,8 @@ common_libsource_server := \
     $(common_libsource_server_dir)/timestamps.c \
     $(common_libsource_server_dir)/JackTools.cpp \
     $(common_libsource_server_dir)/JackMessageBuffer.cpp \
-    $(common_libsource_server_dir)/JackEngineProfiling.cpp \
+    $(common_libsource_server_dir)/JackEngineTrace.cpp \
+    $(common_libsource_server_dir)/JackTimingStats.cpp \
     $(common_libsource_server_dir)/JackAndroidThread.cpp \
     $(common_libsource_server_dir)/JackAndroidSemaphore.cpp \
     $(common_libsource_server_dir)/JackPosixProcessSync.cpp \
@@ -166,7 +169,8 @@ common_libsource_client := \
     $(common_libsource_client_dir)/timestamps.c \
     $(common_libsource_client_dir)/JackTools.cpp \
     $(common_libsource_client_dir)/JackMessageBuffer.cpp \
-    $(common_libsource_client_dir)/JackEngineProfiling.cpp \
+    $(common_libsource_client_dir)/JackEngineTrace.cpp \
+    $(common_libsource_client_dir)/JackTimingStats.cpp \
     $(common_libsource_client_dir)/JackAndroidThread.cpp \
     $(common_libsource_client_dir)/JackAndroidSemaphore.cpp \
     $(common_libsource_client_dir)/JackPosixProcessSync.cpp \
@@ -347,6 +351,23 @@ LOCAL_MODULE := profiler
 
 include $(BUILD_SHARED_LIBRARY)
 
+# ========================================================
+# metrics.so
+# ========================================================
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := ../common/JackMetrics.cpp
+LOCAL_CFLAGS := $(common_cflags) -DSERVER_SIDE
+LOCAL_CPPFLAGS := $(common_cppflags)
+LOCAL_LDFLAGS := $(common_ldflags) $(JACK_STL_LDFLAGS)
+LOCAL_C_INCLUDES := $(common_c_includes)
+LOCAL_SHARED_LIBRARIES := libc libdl libcutils libjackserver
+LOCAL_MODULE_PATH := $(TARGET_OUT_SHARED_LIBRARIES)/jack
+LOCAL_MODULE_TAGS := eng optional
+LOCAL_MODULE := metrics
+
+include $(BUILD_SHARED_LIBRARY)
+
 ## ========================================================
 ## netadapter.so
 ## ========================================================
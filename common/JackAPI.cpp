@@ -29,6 +29,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackTime.h"
 #include "JackPortType.h"
 #include "JackMetadata.h"
+#include "trace.h"
+#include "statistics.h"
 #include <math.h>
 #include "version.h"
 #include <sys/stat.h>           // stat()
@@ -127,6 +129,7 @@ extern "C"
             unsigned long buffer_size);
     LIB_EXPORT int jack_port_unregister(jack_client_t *, jack_port_t *);
     LIB_EXPORT void * jack_port_get_buffer(jack_port_t *, jack_nframes_t);
+    LIB_EXPORT int jack_port_get_buffers(jack_port_t **, void **, unsigned int, jack_nframes_t);
     LIB_EXPORT jack_uuid_t  jack_port_uuid(const jack_port_t*);
     LIB_EXPORT const char*  jack_port_name(const jack_port_t *port);
     LIB_EXPORT const char*  jack_port_short_name(const jack_port_t *port);
@@ -172,6 +175,14 @@ extern "C"
                                 const char* source_port,
                                 const char* destination_port);
     LIB_EXPORT int jack_port_disconnect(jack_client_t *, jack_port_t *);
+    LIB_EXPORT int jack_set_connection_gain(jack_client_t *,
+                                         const char* source_port,
+                                         const char* destination_port,
+                                         float gain);
+    LIB_EXPORT int jack_get_connection_gain(jack_client_t *,
+                                         const char* source_port,
+                                         const char* destination_port,
+                                         float* gain);
     LIB_EXPORT int jack_port_name_size(void);
     LIB_EXPORT int jack_port_type_size(void);
     LIB_EXPORT size_t jack_port_type_get_buffer_size(jack_client_t *client, const char* port_type);
@@ -204,6 +215,24 @@ extern "C"
     LIB_EXPORT float jack_get_max_delayed_usecs(jack_client_t *client);
     LIB_EXPORT float jack_get_xrun_delayed_usecs(jack_client_t *client);
     LIB_EXPORT void jack_reset_max_delayed_usecs(jack_client_t *client);
+    LIB_EXPORT int jack_client_get_timing_stats(jack_client_t *client,
+                                                const char *client_name,
+                                                jack_client_timing_stats_t *stats);
+    LIB_EXPORT int jack_get_driver_wake_histogram(jack_client_t *client,
+                                                  jack_wake_histogram_t *histogram);
+    LIB_EXPORT int jack_get_driver_early_wake_histogram(jack_client_t *client,
+                                                        jack_wake_histogram_t *histogram);
+    LIB_EXPORT int jack_client_get_wake_histogram(jack_client_t *client,
+                                                  const char *client_name,
+                                                  jack_wake_histogram_t *histogram);
+    LIB_EXPORT void jack_reset_wake_histograms(jack_client_t *client);
+
+    LIB_EXPORT uint32_t jack_trace_get_position(jack_client_t *client);
+    LIB_EXPORT int jack_trace_read(jack_client_t *client,
+                                    uint32_t *position,
+                                    jack_trace_event_t *events,
+                                    int count,
+                                    uint32_t *lost);
 
     LIB_EXPORT int jack_release_timebase(jack_client_t *client);
     LIB_EXPORT int jack_set_sync_callback(jack_client_t *client,
@@ -242,6 +271,7 @@ extern "C"
 
     LIB_EXPORT int jack_client_stop_thread(jack_client_t* client, jack_native_thread_t thread);
     LIB_EXPORT int jack_client_kill_thread(jack_client_t* client, jack_native_thread_t thread);
+    LIB_EXPORT int jack_set_process_thread_affinity(jack_client_t* client, const char* cpus);
 #ifndef WIN32
     LIB_EXPORT void jack_set_thread_creator(jack_thread_creator_t jtc);
 #endif
@@ -304,6 +334,14 @@ static inline bool CheckBufferSize(jack_nframes_t buffer_size)
     return (buffer_size >= 1 && buffer_size <= BUFFER_SIZE_MAX);
 }
 
+// RT : buffers of ports owned by a client of this process are resolved once per cycle by the client
+static inline void* GetPortBuffer(JackGraphManager* manager, jack_port_id_t port_index, jack_nframes_t frames)
+{
+    int refnum = manager->GetPort(port_index)->GetRefNum();
+    JackClient* client = (refnum >= 0 && refnum < CLIENT_NUM) ? JackGlobals::fClientTable[refnum] : NULL;
+    return (client) ? client->GetPortBuffer(port_index, frames) : manager->GetBuffer(port_index, frames);
+}
+
 static inline void WaitGraphChange()
 {
     /*
@@ -368,8 +406,32 @@ LIB_EXPORT void* jack_port_get_buffer(jack_port_t* port, jack_nframes_t frames)
         return NULL;
     } else {
         JackGraphManager* manager = GetGraphManager();
-        return (manager ? manager->GetBuffer(myport, frames) : NULL);
+        return (manager ? GetPortBuffer(manager, myport, frames) : NULL);
+    }
+}
+
+LIB_EXPORT int jack_port_get_buffers(jack_port_t** ports, void** buffers, unsigned int count, jack_nframes_t frames)
+{
+    JackGlobals::CheckContext("jack_port_get_buffers");
+
+    JackGraphManager* manager = GetGraphManager();
+    if (!manager || !ports || !buffers) {
+        return -1;
+    }
+
+    int res = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        uintptr_t port_aux = (uintptr_t)ports[i];
+        jack_port_id_t myport = (jack_port_id_t)port_aux;
+        if (CheckPort(myport)) {
+            buffers[i] = GetPortBuffer(manager, myport, frames);
+        } else {
+            jack_error("jack_port_get_buffers called with an incorrect port %ld", myport);
+            buffers[i] = NULL;
+            res = -1;
+        }
     }
+    return res;
 }
 
 LIB_EXPORT jack_uuid_t jack_port_uuid(const jack_port_t* port)
@@ -1230,6 +1292,44 @@ LIB_EXPORT int jack_connect(jack_client_t* ext_client, const char* src, const ch
     }
 }
 
+LIB_EXPORT int jack_set_connection_gain(jack_client_t* ext_client, const char* src, const char* dst, float gain)
+{
+    JackGlobals::CheckContext("jack_set_connection_gain");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_set_connection_gain called with a NULL client");
+        return -1;
+    } else if ((src == NULL) || (dst == NULL)) {
+        jack_error("jack_set_connection_gain called with a NULL port name");
+        return -1;
+    } else {
+        return client->SetConnectionGain(src, dst, gain);
+    }
+}
+
+LIB_EXPORT int jack_get_connection_gain(jack_client_t* ext_client, const char* src, const char* dst, float* gain)
+{
+    JackGlobals::CheckContext("jack_get_connection_gain");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_get_connection_gain called with a NULL client");
+        return -1;
+    } else if ((src == NULL) || (dst == NULL) || (gain == NULL)) {
+        jack_error("jack_get_connection_gain called with a NULL argument");
+        return -1;
+    } else {
+        WaitGraphChange();
+        JackGraphManager* manager = GetGraphManager();
+        jack_port_id_t port_src, port_dst;
+        if (!manager || manager->GetTwoPorts(src, dst, &port_src, &port_dst) < 0) {
+            return -1;
+        }
+        return manager->GetConnectionGain(port_src, port_dst, gain);
+    }
+}
+
 LIB_EXPORT int jack_disconnect(jack_client_t* ext_client, const char* src, const char* dst)
 {
     JackGlobals::CheckContext("jack_disconnect");
@@ -1711,6 +1811,148 @@ LIB_EXPORT void jack_reset_max_delayed_usecs(jack_client_t* ext_client)
     }
 }
 
+LIB_EXPORT int jack_client_get_timing_stats(jack_client_t* ext_client, const char* client_name, jack_client_timing_stats_t* stats)
+{
+    JackGlobals::CheckContext("jack_client_get_timing_stats");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_client_get_timing_stats called with a NULL client");
+        return -1;
+    } else if (client_name == NULL || stats == NULL) {
+        return -1;
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        return (control && control->GetClientTimingStats(client_name, stats)) ? 0 : -1;
+    }
+}
+
+LIB_EXPORT int jack_get_driver_wake_histogram(jack_client_t* ext_client, jack_wake_histogram_t* histogram)
+{
+    JackGlobals::CheckContext("jack_get_driver_wake_histogram");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_get_driver_wake_histogram called with a NULL client");
+        return -1;
+    } else if (histogram == NULL) {
+        return -1;
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        return (control && control->GetDriverWakeHistogram(histogram)) ? 0 : -1;
+    }
+}
+
+LIB_EXPORT int jack_get_driver_early_wake_histogram(jack_client_t* ext_client, jack_wake_histogram_t* histogram)
+{
+    JackGlobals::CheckContext("jack_get_driver_early_wake_histogram");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_get_driver_early_wake_histogram called with a NULL client");
+        return -1;
+    } else if (histogram == NULL) {
+        return -1;
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        return (control && control->GetDriverEarlyWakeHistogram(histogram)) ? 0 : -1;
+    }
+}
+
+LIB_EXPORT int jack_client_get_wake_histogram(jack_client_t* ext_client, const char* client_name, jack_wake_histogram_t* histogram)
+{
+    JackGlobals::CheckContext("jack_client_get_wake_histogram");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_client_get_wake_histogram called with a NULL client");
+        return -1;
+    } else if (client_name == NULL || histogram == NULL) {
+        return -1;
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        return (control && control->GetClientWakeHistogram(client_name, histogram)) ? 0 : -1;
+    }
+}
+
+LIB_EXPORT void jack_reset_wake_histograms(jack_client_t* ext_client)
+{
+    JackGlobals::CheckContext("jack_reset_wake_histograms");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_reset_wake_histograms called with a NULL client");
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        if (control) {
+            control->ResetWakeHistograms();
+        }
+    }
+}
+
+// trace.h
+LIB_EXPORT uint32_t jack_trace_get_position(jack_client_t* ext_client)
+{
+    JackGlobals::CheckContext("jack_trace_get_position");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_trace_get_position called with a NULL client");
+        return 0;
+    } else {
+        JackEngineControl* control = GetEngineControl();
+        return (control ? control->fTrace.GetPosition() : 0);
+    }
+}
+
+LIB_EXPORT int jack_trace_read(jack_client_t* ext_client, uint32_t* position, jack_trace_event_t* events, int count, uint32_t* lost)
+{
+    JackGlobals::CheckContext("jack_trace_read");
+
+    JackClient* client = (JackClient*)ext_client;
+    JackEngineControl* control = GetEngineControl();
+    if (client == NULL) {
+        jack_error("jack_trace_read called with a NULL client");
+        return -1;
+    } else if (position == NULL || events == NULL || count < 0 || control == NULL) {
+        return -1;
+    }
+
+    JackTraceEvent trace_events[64];
+    UInt32 pos = *position;
+    UInt32 lost_events = 0;
+    int res = 0;
+
+    while (res < count) {
+        UInt32 lost_now;
+        int chunk = count - res;
+        int read = control->fTrace.Read(&pos, trace_events, (chunk < 64) ? chunk : 64, &lost_now);
+        lost_events += lost_now;
+        for (int i = 0; i < read; i++) {
+            events[res + i].cycle = trace_events[i].fCycle;
+            events[res + i].status = trace_events[i].fStatus;
+            events[res + i].client = trace_events[i].fClient;
+            events[res + i].signaled = trace_events[i].fSignaledAt;
+            events[res + i].awake = trace_events[i].fAwakeAt;
+            events[res + i].finished = trace_events[i].fFinishedAt;
+            events[res + i].triggered_by = trace_events[i].fTriggeredBy;
+            events[res + i].slack = trace_events[i].fSlack;
+            events[res + i].critical = trace_events[i].fCritical;
+            events[res + i].period_usecs = trace_events[i].fPeriodUsecs;
+        }
+        res += read;
+        if (read == 0 && lost_now == 0) {
+            break;
+        }
+    }
+
+    *position = pos;
+    if (lost) {
+        *lost = lost_events;
+    }
+    return res;
+}
+
 // thread.h
 LIB_EXPORT int jack_client_real_time_priority(jack_client_t* ext_client)
 {
@@ -1781,6 +2023,19 @@ LIB_EXPORT int jack_client_kill_thread(jack_client_t* client, jack_native_thread
     return JackThread::KillImp(thread);
 }
 
+LIB_EXPORT int jack_set_process_thread_affinity(jack_client_t* ext_client, const char* cpus)
+{
+    JackGlobals::CheckContext("jack_set_process_thread_affinity");
+
+    JackClient* client = (JackClient*)ext_client;
+    if (client == NULL) {
+        jack_error("jack_set_process_thread_affinity called with a NULL client");
+        return -1;
+    } else {
+        return client->SetProcessThreadAffinity(cpus);
+    }
+}
+
 #ifndef WIN32
 LIB_EXPORT void jack_set_thread_creator (jack_thread_creator_t jtc)
 {
@@ -27,15 +27,21 @@ namespace Jack
 {
 
 bool JackActivationCount::Signal(JackSynchro* synchro, JackClientControl* control)
+{
+    return (Trigger(control)) ? synchro->Signal() : true;
+}
+
+/*!
+\brief Decrement the counter, returns true when the client has to run.
+*/
+bool JackActivationCount::Trigger(JackClientControl* control)
 {
     if (fValue == 0) {
         // Transfer activation to next clients
         jack_log("JackActivationCount::Signal value = 0 ref = %ld", control->fRefNum);
-        return synchro->Signal();
-    } else if (DEC_ATOMIC(&fValue) == 1) {
-        return synchro->Signal();
-    } else {
         return true;
+    } else {
+        return (DEC_ATOMIC(&fValue) == 1);
     }
 }
 
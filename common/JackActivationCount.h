@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackPlatformPlug.h"
 #include "JackTime.h"
 #include "JackTypes.h"
+#include "JackConstants.h"
 
 namespace Jack
 {
@@ -31,6 +32,9 @@ struct JackClientControl;
 
 /*!
 \brief Client activation counter.
+
+Counters of clients finishing at the same time on different CPUs are decremented concurrently,
+each one is padded to a full cache line.
 */
 
 PRE_PACKED_STRUCTURE
@@ -41,6 +45,7 @@ class JackActivationCount
 
         alignas(SInt32) SInt32 fValue;
         SInt32 fCount;
+        char fPadding[JACK_CACHE_LINE_SIZE - 2 * sizeof(SInt32)];
 
     public:
 
@@ -48,9 +53,12 @@ class JackActivationCount
         {
             static_assert(offsetof(JackActivationCount, fValue) % sizeof(fValue) == 0,
                           "fValue must be aligned within JackActivationCount");
+            static_assert(sizeof(JackActivationCount) == JACK_CACHE_LINE_SIZE,
+                          "JackActivationCount must fill a cache line");
         }
 
         bool Signal(JackSynchro* synchro, JackClientControl* control);
+        bool Trigger(JackClientControl* control);
 
         inline void Reset()
         {
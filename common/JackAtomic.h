@@ -23,6 +23,22 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackTypes.h"
 #include "JackAtomic_os.h"
 
+/* Ordering of plain loads and stores shared with other threads or processes, JACK_FULL_FENCE also orders a store before a later load */
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+    #define JACK_ACQ_FENCE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+    #define JACK_REL_FENCE() __atomic_thread_fence(__ATOMIC_RELEASE)
+    #define JACK_FULL_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__GNUC__)
+    #define JACK_ACQ_FENCE() __sync_synchronize()
+    #define JACK_REL_FENCE() __sync_synchronize()
+    #define JACK_FULL_FENCE() __sync_synchronize()
+#elif defined(_MSC_VER)
+    #include <windows.h>
+    #define JACK_ACQ_FENCE() MemoryBarrier()
+    #define JACK_REL_FENCE() MemoryBarrier()
+    #define JACK_FULL_FENCE() MemoryBarrier()
+#endif
+
 static inline long INC_ATOMIC(volatile SInt32* val)
 {
     SInt32 actual;
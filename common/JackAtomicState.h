@@ -80,13 +80,21 @@ struct AtomicCounter
 #define CurArrayIndex(e) (CurIndex(e) & 0x0001)
 #define NextArrayIndex(e) ((CurIndex(e) + 1) & 0x0001)
 
+/*!
+\brief Prepare the next state from the current one, to be overloaded by states that do not have to be entirely copied.
+*/
+template <class T>
+inline void JackCopyState(T* dst, const T* src)
+{
+    memcpy(dst, src, sizeof(T));
+}
+
 /*!
 \brief A class to handle two states (switching from one to the other) in a lock-free manner
 */
 
 // CHECK livelock
 
-PRE_PACKED_STRUCTURE
 template <class T>
 class JackAtomicState
 {
@@ -113,7 +121,7 @@ class JackAtomicState
                 NextIndex(new_val) = CurIndex(new_val); // Invalidate next index
             } while (!CAS(Counter(old_val), Counter(new_val), (UInt32*)&fCounter));
             if (need_copy)
-                memcpy(&fState[next_index], &fState[cur_index], sizeof(T));
+                JackCopyState(&fState[next_index], &fState[cur_index]);
             return next_index;
         }
 
@@ -157,6 +165,14 @@ class JackAtomicState
             return CurIndex(fCounter);
         }
 
+        /*!
+        \brief Returns the index of the last written state, the current one when there is no pending change
+        */
+        UInt16 GetNextIndex()
+        {
+            return NextIndex(fCounter);
+        }
+
         /*!
         \brief Tries to switch to the next state and returns the new current state (either the same as before if case of switch failure or the new one)
         */
@@ -257,7 +273,7 @@ class JackAtomicState
         }
         */
 
-} POST_PACKED_STRUCTURE;
+};
 
 } // end of namespace
 
@@ -154,6 +154,77 @@ static void AudioBufferMixdown(void* mixbuffer, void** src_buffers, int src_coun
     }
 }
 
+/*!
+\brief Mix buffer scaled by a gain, ramped by step at each frame : the first source is stored, the next ones added.
+*/
+static inline void MixAudioBufferGain(jack_default_audio_sample_t* mixbuffer, jack_default_audio_sample_t* buffer, float gain, float step, jack_nframes_t frames, bool first)
+{
+#ifdef __APPLE__
+    if (first) {
+        vDSP_vrampmul(buffer, 1, &gain, &step, mixbuffer, 1, frames);
+    } else {
+        vDSP_vrampmuladd(buffer, 1, &gain, &step, mixbuffer, 1, frames);
+    }
+#else
+    #if defined (__SSE__) && !defined (__sun__)
+    __m128 vgain = _mm_setr_ps(gain, gain + step, gain + 2 * step, gain + 3 * step);
+    __m128 vstep = _mm_set1_ps(4 * step);
+
+    for (; frames >= 4; frames -= 4) {
+        __m128 vec = _mm_mul_ps(_mm_load_ps(buffer), vgain);
+        if (!first) {
+            vec = _mm_add_ps(vec, _mm_load_ps(mixbuffer));
+        }
+        _mm_store_ps(mixbuffer, vec);
+        vgain = _mm_add_ps(vgain, vstep);
+        mixbuffer += 4;
+        buffer += 4;
+    }
+    gain = _mm_cvtss_f32(vgain);
+    #elif defined (__ARM_NEON__) || defined (__ARM_NEON)
+    const float ramp[4] = { gain, gain + step, gain + 2 * step, gain + 3 * step };
+    float32x4_t vgain = vld1q_f32(ramp);
+    float32x4_t vstep = vdupq_n_f32(4 * step);
+
+    for (; frames >= 4; frames -= 4) {
+        float32x4_t vec = vmulq_f32(vld1q_f32(buffer), vgain);
+        if (!first) {
+            vec = vaddq_f32(vec, vld1q_f32(mixbuffer));
+        }
+        vst1q_f32(mixbuffer, vec);
+        vgain = vaddq_f32(vgain, vstep);
+        mixbuffer += 4;
+        buffer += 4;
+    }
+    gain = vgetq_lane_f32(vgain, 0);
+    #endif
+
+    for (; frames > 0; frames--) {
+        jack_default_audio_sample_t sample = *buffer++ * gain;
+        *mixbuffer = (first) ? sample : *mixbuffer + sample;
+        mixbuffer++;
+        gain += step;
+    }
+#endif
+}
+
+/*!
+\brief Mixdown of a summing bus : gains and mix are computed in the same pass over each source.
+*/
+static void AudioBufferMixdownGain(void* mixbuffer, void** src_buffers, const float* from_gains, const float* to_gains, int src_count, jack_nframes_t nframes)
+{
+    float scale = (nframes > 0) ? 1.f / nframes : 0.f;
+
+    for (int i = 0; i < src_count; ++i) {
+        MixAudioBufferGain(static_cast<jack_default_audio_sample_t*>(mixbuffer),
+                           static_cast<jack_default_audio_sample_t*>(src_buffers[i]),
+                           from_gains[i],
+                           (to_gains[i] - from_gains[i]) * scale,
+                           nframes,
+                           i == 0);
+    }
+}
+
 static size_t AudioBufferSize()
 {
     return GetEngineControl()->fBufferSize * sizeof(jack_default_audio_sample_t);
@@ -164,7 +235,8 @@ const JackPortType gAudioPortType =
     JACK_DEFAULT_AUDIO_TYPE,
     AudioBufferSize,
     AudioBufferInit,
-    AudioBufferMixdown
+    AudioBufferMixdown,
+    AudioBufferMixdownGain
 };
 
 } // namespace Jack
@@ -152,6 +152,8 @@ class JackClientChannelInterface
         {}
         virtual void PortRename(int refnum, jack_port_id_t port, const char* name, int* result)
         {}
+        virtual void SetConnectionGain(int refnum, const char* src, const char* dst, float gain, int* result)
+        {}
 
         virtual void SetBufferSize(jack_nframes_t buffer_size, int* result)
         {}
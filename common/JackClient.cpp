@@ -28,6 +28,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackTransportEngine.h"
 #include "driver_interface.h"
 #include "JackLibGlobals.h"
+#include "JackTools.h"
+#include "JackAtomic.h"
 
 #include <math.h>
 #include <string>
@@ -83,10 +85,21 @@ JackClient::JackClient(JackSynchro* table):fThread(this)
     fPropertyChangeArg = NULL;
 
     fSessionReply = kPendingSessionReply;
+    fCPUs[0] = 0;
+
+    fCycle = 0;
+    fEndPending = false;
+    for (int i = 0; i < PORT_NUM_MAX / CYCLE_BUFFER_CHUNK; i++) {
+        fCycleBuffer[i] = NULL;
+    }
 }
 
 JackClient::~JackClient()
-{}
+{
+    for (int i = 0; i < PORT_NUM_MAX / CYCLE_BUFFER_CHUNK; i++) {
+        delete[] fCycleBuffer[i];
+    }
+}
 
 void JackClient::ShutDown(jack_status_t code, const char* message)
 {
@@ -554,13 +567,41 @@ void JackClient::SetupRealTime()
     // Will do "something" on OSX only...
     fThread.SetParams(GetEngineControl()->fPeriod, GetEngineControl()->fComputation, GetEngineControl()->fConstraint);
 
+    // Will do "something" on Linux only...
+    if (GetEngineControl()->fDeadlineRuntime > 0) {
+        fThread.SetDeadline(GetEngineControl()->DeadlineRuntime(), GetEngineControl()->fConstraint, GetEngineControl()->fPeriod);
+    }
+
     if (fThread.AcquireSelfRealTime(GetEngineControl()->fClientPriority) < 0) {
         jack_error("JackClient::AcquireSelfRealTime error");
     }
 }
 
+/*!
+\brief Choose the RT thread CPUs : explicit request first, then JACK_CLIENT_CPUS, then the server suggestion.
+*/
+void JackClient::SetupAffinity()
+{
+    const char* env_cpus = getenv("JACK_CLIENT_CPUS");
+    char suggested_cpu[16];
+
+    if (fCPUs[0]) {
+        fThread.SetAffinity(fCPUs);
+    } else if (env_cpus && env_cpus[0]) {
+        fThread.SetAffinity(env_cpus);
+    } else if (GetClientControl()->fSuggestedCPU >= 0) {
+        snprintf(suggested_cpu, sizeof(suggested_cpu), "%d", GetClientControl()->fSuggestedCPU);
+        fThread.SetAffinity(suggested_cpu);
+    } else {
+        fThread.SetAffinity(NULL);
+    }
+}
+
 int JackClient::StartThread()
 {
+    SetupAffinity();
+    fEndPending = false;
+
     if (fThread.StartSync() < 0) {
         jack_error("Start thread error");
         return -1;
@@ -600,11 +641,23 @@ inline void JackClient::ExecuteThread()
     }
 }
 
+// A new odd value for each cycle, even out of cycles so that nothing is cached there
+inline void JackClient::CycleBegin()
+{
+    fCycle = (fCycle + 2) | 1;
+}
+
+inline void JackClient::CycleEnd()
+{
+    fCycle = fCycle & ~1U;
+}
+
 inline jack_nframes_t JackClient::CycleWaitAux()
 {
     if (!WaitSync()) {
         Error();   // Terminates the thread
     }
+    CycleBegin();
     CallSyncCallbackAux();
     return GetEngineControl()->fBufferSize;
 }
@@ -614,6 +667,7 @@ inline void JackClient::CycleSignalAux(int status)
     if (status == 0) {
         CallTimebaseCallbackAux();
     }
+    CycleEnd();
     SignalSync();
     if (status != 0) {
         End();     // Terminates the thread
@@ -630,6 +684,58 @@ void JackClient::CycleSignal(int status)
     CycleSignalAux(status);
 }
 
+/*!
+\brief Whether a cycle can be run on another thread : not when the client drives its own thread loop.
+*/
+bool JackClient::CanExecuteCycle()
+{
+    return (fThreadFun == NULL);
+}
+
+/*!
+\brief Run a cycle on the calling thread, for an internal client woken by the server worker pool : returns the process status.
+*/
+int JackClient::ExecuteCycle()
+{
+    if (GetGraphManager()->AwakeRefNum(GetClientControl(), fSynchroTable) < 0) {
+        jack_error("AwakeRefNum error");
+    }
+    // Waiting for ExecuteCycleEnd : only keep the graph running meanwhile
+    if (fEndPending) {
+        SignalSync();
+        return 0;
+    }
+    CycleBegin();
+    CallSyncCallbackAux();
+    int status = CallProcessCallback();
+    if (status == 0) {
+        CallTimebaseCallbackAux();
+    }
+    CycleEnd();
+    SignalSync();
+    if (status != 0) {
+        jack_log("JackClient::ExecuteCycle end name = %s", GetClientControl()->fName);
+        fEndPending = true;
+    }
+    return status;
+}
+
+/*!
+\brief Like End, on a non RT thread once ExecuteCycle returned a non-zero status.
+*/
+void JackClient::ExecuteCycleEnd()
+{
+    jack_log("JackClient::ExecuteCycleEnd name = %s", GetClientControl()->fName);
+    // Deactivated in the meantime
+    if (!fEndPending || !IsActive()) {
+        return;
+    }
+    int result;
+    GetClientControl()->fActive = false;
+    fChannel->ClientDeactivate(GetClientControl()->fRefNum, &result);
+    fThread.Kill();
+}
+
 inline int JackClient::CallProcessCallback()
 {
     return (fProcess != NULL) ? fProcess(GetEngineControl()->fBufferSize, fProcessArg) : 0;
@@ -715,6 +821,13 @@ int JackClient::PortRegister(const char* port_name, const char* port_type, unsig
     if (result == 0) {
         jack_log("JackClient::PortRegister ref = %ld name = %s type = %s port_index = %ld", GetClientControl()->fRefNum, port_full_name_str.c_str(), port_type, port_index);
         fPortList.push_back(port_index);
+        // Kept until the client is destroyed : the RT thread may be reading it
+        int chunk = port_index / CYCLE_BUFFER_CHUNK;
+        if (fCycleBuffer[chunk] == NULL) {
+            JackCycleBuffer* buffers = new JackCycleBuffer[CYCLE_BUFFER_CHUNK]();
+            JACK_REL_FENCE();
+            fCycleBuffer[chunk] = buffers;
+        }
         return port_index;
     } else {
         return 0;
@@ -728,6 +841,7 @@ int JackClient::PortUnRegister(jack_port_id_t port_index)
 
     if (it != fPortList.end()) {
         fPortList.erase(it);
+        GetCycleBuffer(port_index)->fCycle = 0;
         int result = -1;
         fChannel->PortUnRegister(GetClientControl()->fRefNum, port_index, &result);
         return result;
@@ -769,6 +883,22 @@ int JackClient::PortDisconnect(const char* src, const char* dst)
     return result;
 }
 
+int JackClient::SetConnectionGain(const char* src, const char* dst, float gain)
+{
+    jack_log("JackClient::SetConnectionGain src = %s dst = %s gain = %f", src, dst, gain);
+    if (strlen(src) >= REAL_JACK_PORT_NAME_SIZE) {
+        jack_error("\"%s\" is too long to be used as a JACK port name.\n", src);
+        return -1;
+    }
+    if (strlen(dst) >= REAL_JACK_PORT_NAME_SIZE) {
+        jack_error("\"%s\" is too long to be used as a JACK port name.\n", dst);
+        return -1;
+    }
+    int result = -1;
+    fChannel->SetConnectionGain(GetClientControl()->fRefNum, src, dst, gain, &result);
+    return result;
+}
+
 int JackClient::PortDisconnect(jack_port_id_t src)
 {
     jack_log("JackClient::PortDisconnect src = %ld", src);
@@ -783,6 +913,43 @@ int JackClient::PortIsMine(jack_port_id_t port_index)
     return GetClientControl()->fRefNum == port->GetRefNum();
 }
 
+JackCycleBuffer* JackClient::GetCycleBuffer(jack_port_id_t port_index)
+{
+    JackCycleBuffer* chunk = fCycleBuffer[port_index / CYCLE_BUFFER_CHUNK];
+    return (chunk) ? &chunk[port_index % CYCLE_BUFFER_CHUNK] : NULL;
+}
+
+/*!
+\brief RT : resolve the port buffer once per cycle, an input mixed from several outputs is then mixed only once.
+*/
+void* JackClient::GetPortBuffer(jack_port_id_t port_index, jack_nframes_t frames)
+{
+    JackCycleBuffer* cached = GetCycleBuffer(port_index);
+    UInt32 cycle = fCycle;
+
+    // Nothing is kept out of cycles, nor for ports of other clients
+    if ((cycle & 1) == 0 || !cached) {
+        return GetGraphManager()->GetBuffer(port_index, frames);
+    }
+
+    if (cached->fCycle == cycle) {
+        JACK_ACQ_FENCE();
+        if (cached->fFrames == frames) {
+            return cached->fBuffer;
+        }
+    }
+
+    bool cacheable;
+    void* buffer = GetGraphManager()->GetBuffer(port_index, frames, &cacheable);
+    if (cacheable) {
+        cached->fBuffer = buffer;
+        cached->fFrames = frames;
+        JACK_REL_FENCE();
+        cached->fCycle = cycle;
+    }
+    return buffer;
+}
+
 int JackClient::PortRename(jack_port_id_t port_index, const char* name)
 {
     int result = -1;
@@ -1182,6 +1349,22 @@ int JackClient::SetProcessThread(JackThreadCallback fun, void *arg)
     }
 }
 
+int JackClient::SetProcessThreadAffinity(const char* cpus)
+{
+    int cpu_list[JACK_CPU_LIST_MAX];
+
+    if (IsActive()) {
+        jack_error("You cannot set the process thread affinity on an active client");
+        return -1;
+    } else if (cpus && (strlen(cpus) >= sizeof(fCPUs) || JackTools::ParseCPUList(cpus, cpu_list, JACK_CPU_LIST_MAX) < 0)) {
+        jack_error("Invalid CPU list %s", cpus);
+        return -1;
+    } else {
+        strcpy(fCPUs, (cpus) ? cpus : "");
+        return 0;
+    }
+}
+
 int JackClient::SetSessionCallback(JackSessionCallback callback, void *arg)
 {
     if (IsActive()) {
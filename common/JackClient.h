@@ -41,6 +41,19 @@ class JackEngine;
 struct JackClientControl;
 struct JackEngineControl;
 
+#define CYCLE_BUFFER_CHUNK 64      // Resolved port buffers are kept by chunks of consecutive port indexes
+
+/*!
+\brief A port buffer, as resolved for a given cycle.
+*/
+
+struct JackCycleBuffer
+{
+    volatile UInt32 fCycle;
+    jack_nframes_t fFrames;
+    void* fBuffer;
+};
+
 /*!
 \brief The base class for clients: share part of the implementation for JackInternalClient and JackLibClient.
 */
@@ -92,6 +105,7 @@ class SERVER_EXPORT JackClient : public JackClientInterface, public JackRunnable
         void* fPropertyChangeArg;
 
         char fServerName[JACK_SERVER_NAME_SIZE+1];
+        char fCPUs[JACK_CPU_LIST_SIZE];     /*! CPUs requested for the RT thread, empty to use the server suggestion */
 
         JackThread fThread;    /*! Thread to execute the Process function */
         detail::JackClientChannelInterface* fChannel;
@@ -100,9 +114,15 @@ class SERVER_EXPORT JackClient : public JackClientInterface, public JackRunnable
 
         JackSessionReply fSessionReply;
 
+        volatile UInt32 fCycle;                         /*! Odd while a cycle is running, changed by each cycle */
+        JackCycleBuffer* volatile fCycleBuffer[PORT_NUM_MAX / CYCLE_BUFFER_CHUNK];   /*! Port buffers already resolved in the running cycle, only the chunks of the client ports are allocated */
+        volatile bool fEndPending;                      /*! A cycle run by a server worker returned a non-zero status, until ExecuteCycleEnd */
+
         int StartThread();
+        void SetupAffinity();
         void SetupDriverSync(bool freewheel);
         bool IsActive();
+        JackCycleBuffer* GetCycleBuffer(jack_port_id_t port_index);
 
         void CallSyncCallback();
         void CallTimebaseCallback();
@@ -116,6 +136,8 @@ class SERVER_EXPORT JackClient : public JackClientInterface, public JackRunnable
         inline int CallProcessCallback();
         inline void End();
         inline void Error();
+        inline void CycleBegin();
+        inline void CycleEnd();
         inline jack_nframes_t CycleWaitAux();
         inline void CycleSignalAux(int status);
         inline void CallSyncCallbackAux();
@@ -159,8 +181,10 @@ class SERVER_EXPORT JackClient : public JackClientInterface, public JackRunnable
         virtual int PortConnect(const char* src, const char* dst);
         virtual int PortDisconnect(const char* src, const char* dst);
         virtual int PortDisconnect(jack_port_id_t src);
+        virtual int SetConnectionGain(const char* src, const char* dst, float gain);
 
         virtual int PortIsMine(jack_port_id_t port_index);
+        void* GetPortBuffer(jack_port_id_t port_index, jack_nframes_t frames);
         virtual int PortRename(jack_port_id_t port_index, const char* name);
 
         // Transport
@@ -203,6 +227,12 @@ class SERVER_EXPORT JackClient : public JackClientInterface, public JackRunnable
         jack_nframes_t CycleWait();
         void CycleSignal(int status);
         virtual int SetProcessThread(JackThreadCallback fun, void *arg);
+        virtual int SetProcessThreadAffinity(const char* cpus);
+
+        // Cycles run by the server worker pool (internal clients)
+        bool CanExecuteCycle();
+        int ExecuteCycle();
+        void ExecuteCycleEnd();
 
         // Session API
         virtual jack_session_command_t* SessionNotify(const char* target, jack_session_event_type_t type, const char* path);
@@ -45,6 +45,7 @@ struct JackClientControl : public JackShmMemAble
     int fRefNum;
     int fPID;
     bool fActive;
+    int fSuggestedCPU;     // CPU suggested by the server for the RT thread, -1 if none
 
     jack_uuid_t fSessionID;
     char fSessionCommand[JACK_SESSION_COMMAND_SIZE];
@@ -85,6 +86,7 @@ struct JackClientControl : public JackShmMemAble
         fTransportSync = false;
         fTransportTimebase = false;
         fActive = false;
+        fSuggestedCPU = -1;
 
         fSessionID = uuid;
     }
@@ -20,38 +20,102 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackConnectionManager.h"
 #include "JackClientControl.h"
 #include "JackEngineControl.h"
+#include "JackGraphManager.h"
 #include "JackGlobals.h"
 #include "JackError.h"
-#include <set>
+#include "JackAtomic.h"
+#include <algorithm>
 #include <iostream>
+#include <new>
 #include <assert.h>
+#include <stdlib.h>
+#ifdef WIN32
+#include <malloc.h>
+#endif
 
 namespace Jack
 {
 
+void* JackConnectionManager::operator new(size_t size)
+{
+    void* ptr;
+#ifdef WIN32
+    ptr = _aligned_malloc(size, JACK_CACHE_LINE_SIZE);
+#else
+    if (posix_memalign(&ptr, JACK_CACHE_LINE_SIZE, size) != 0) {
+        ptr = NULL;
+    }
+#endif
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void JackConnectionManager::operator delete(void* ptr)
+{
+#ifdef WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
 JackConnectionManager::JackConnectionManager()
 {
     int i;
-    static_assert(offsetof(JackConnectionManager, fInputCounter) % sizeof(UInt32) == 0,
-                  "fInputCounter must be aligned within JackConnectionManager");
+    static_assert(offsetof(JackConnectionManager, fInputCounter) % JACK_CACHE_LINE_SIZE == 0,
+                  "fInputCounter must be cache line aligned within JackConnectionManager");
 
     jack_log("JackConnectionManager::InitConnections size = %ld ", sizeof(JackConnectionManager));
 
     for (i = 0; i < PORT_NUM_MAX; i++) {
-        fConnection[i].Init();
+        fDelaySlot[i] = EMPTY;
+        fMixPort[i] = false;
+        fBusPort[i] = false;
+        fGainIndex[i] = 0;
     }
+    fDelayPortCount = 0;
 
     fLoopFeedback.Init();
 
     jack_log("JackConnectionManager::InitClients");
     for (i = 0; i < CLIENT_NUM; i++) {
-        InitRefNum(i);
+        fConnectionRef.Init(i);
+        fInputCounter[i].SetValue(0);
+        fStage[i] = 0;
+        fSuccessor[i].Init();
+        fWakeCount[i] = 0;
+        fWakeSource[i] = EMPTY;
+        fMixPortCount[i] = 0;
     }
+    fActiveRefNum.Init();
 }
 
 JackConnectionManager::~JackConnectionManager()
 {}
 
+/*!
+\brief Copy the current state in the next one, src being the state made from this one.
+*/
+void JackConnectionManager::Copy(const JackConnectionManager& src)
+{
+    memcpy((void*)this, (const void*)&src, offsetof(JackConnectionManager, fConnection));
+    fConnection.Copy(src.fConnection);
+    fInputPort.Copy(src.fInputPort);
+    fOutputPort.Copy(src.fOutputPort);
+}
+
+/*!
+\brief The state has been entirely written : it will be entirely copied.
+*/
+void JackConnectionManager::SetChanged()
+{
+    fConnection.SetChanged();
+    fInputPort.SetChanged();
+    fOutputPort.SetChanged();
+}
+
 //--------------
 // Internal API
 //--------------
@@ -92,7 +156,7 @@ int JackConnectionManager::Connect(jack_port_id_t port_src, jack_port_id_t port_
 {
     jack_log("JackConnectionManager::Connect port_src = %ld port_dst = %ld", port_src, port_dst);
 
-    if (fConnection[port_src].AddItem(port_dst)) {
+    if (fConnection.AddItem(port_src, port_dst)) {
         return 0;
     } else {
         jack_error("Connection table is full !!");
@@ -107,7 +171,11 @@ int JackConnectionManager::Disconnect(jack_port_id_t port_src, jack_port_id_t po
 {
     jack_log("JackConnectionManager::Disconnect port_src = %ld port_dst = %ld", port_src, port_dst);
 
-    if (fConnection[port_src].RemoveItem(port_dst)) {
+    if (fConnection.RemoveItem(port_src, port_dst)) {
+        // Back to a plain input once disconnected
+        if (fConnection.GetItemCount(port_src) == 0) {
+            fBusPort[port_src] = false;
+        }
         return 0;
     } else {
         jack_error("Connection not found !!");
@@ -120,7 +188,47 @@ int JackConnectionManager::Disconnect(jack_port_id_t port_src, jack_port_id_t po
 */
 bool JackConnectionManager::IsConnected(jack_port_id_t port_src, jack_port_id_t port_dst) const
 {
-    return fConnection[port_src].CheckItem(port_dst);
+    return fConnection.CheckItem(port_src, port_dst);
+}
+
+/*!
+\brief Set the gain of the port_src to port_dst connection, index being the one of the state being written.
+*/
+int JackConnectionManager::SetGain(jack_port_id_t port_src, jack_port_id_t port_dst, float gain, UInt16 index)
+{
+    jack_log("JackConnectionManager::SetGain port_src = %ld port_dst = %ld gain = %f", port_src, port_dst, gain);
+
+    int pos = fConnection.FindItem(port_dst, port_src);
+    if (pos < 0) {
+        jack_error("Connection not found !!");
+        return -1;
+    }
+
+    // First change in this state : ramp from the gains of the previous one
+    if (!fBusPort[port_dst] || fGainIndex[port_dst] != index) {
+        for (int i = 0; i < fConnection.GetItemCount(port_dst); i++) {
+            JackConnectionGain value = fConnection.GetValue(port_dst, i);
+            value.fPrevGain = value.fGain;
+            fConnection.SetValue(port_dst, i, value);
+        }
+        fGainIndex[port_dst] = index;
+        fBusPort[port_dst] = true;
+    }
+
+    JackConnectionGain value = fConnection.GetValue(port_dst, pos);
+    value.fGain = gain;
+    fConnection.SetValue(port_dst, pos, value);
+    return 0;
+}
+
+int JackConnectionManager::GetGain(jack_port_id_t port_src, jack_port_id_t port_dst, float* gain) const
+{
+    int pos = fConnection.FindItem(port_dst, port_src);
+    if (pos < 0) {
+        return -1;
+    }
+    *gain = fConnection.GetValue(port_dst, pos).fGain;
+    return 0;
 }
 
 /*!
@@ -128,7 +236,7 @@ bool JackConnectionManager::IsConnected(jack_port_id_t port_src, jack_port_id_t
 */
 const jack_int_t* JackConnectionManager::GetConnections(jack_port_id_t port_index) const
 {
-    return fConnection[port_index].GetItems();
+    return fConnection.GetItems(port_index);
 }
 
 //------------------------
@@ -140,7 +248,7 @@ const jack_int_t* JackConnectionManager::GetConnections(jack_port_id_t port_inde
 */
 int JackConnectionManager::AddInputPort(int refnum, jack_port_id_t port_index)
 {
-    if (fInputPort[refnum].AddItem(port_index)) {
+    if (fInputPort.AddItem(refnum, port_index)) {
         jack_log("JackConnectionManager::AddInputPort ref = %ld port = %ld", refnum, port_index);
         return 0;
     } else {
@@ -154,7 +262,7 @@ int JackConnectionManager::AddInputPort(int refnum, jack_port_id_t port_index)
 */
 int JackConnectionManager::AddOutputPort(int refnum, jack_port_id_t port_index)
 {
-    if (fOutputPort[refnum].AddItem(port_index)) {
+    if (fOutputPort.AddItem(refnum, port_index)) {
         jack_log("JackConnectionManager::AddOutputPort ref = %ld port = %ld", refnum, port_index);
         return 0;
     } else {
@@ -170,7 +278,7 @@ int JackConnectionManager::RemoveInputPort(int refnum, jack_port_id_t port_index
 {
     jack_log("JackConnectionManager::RemoveInputPort ref = %ld port_index = %ld ", refnum, port_index);
 
-    if (fInputPort[refnum].RemoveItem(port_index)) {
+    if (fInputPort.RemoveItem(refnum, port_index)) {
         return 0;
     } else {
         jack_error("Input port index = %ld not found for application ref = %ld", port_index, refnum);
@@ -185,7 +293,7 @@ int JackConnectionManager::RemoveOutputPort(int refnum, jack_port_id_t port_inde
 {
     jack_log("JackConnectionManager::RemoveOutputPort ref = %ld port_index = %ld ", refnum, port_index);
 
-    if (fOutputPort[refnum].RemoveItem(port_index)) {
+    if (fOutputPort.RemoveItem(refnum, port_index)) {
         return 0;
     } else {
         jack_error("Output port index = %ld not found for application ref = %ld", port_index, refnum);
@@ -198,7 +306,7 @@ int JackConnectionManager::RemoveOutputPort(int refnum, jack_port_id_t port_inde
 */
 const jack_int_t* JackConnectionManager::GetInputPorts(int refnum)
 {
-    return fInputPort[refnum].GetItems();
+    return fInputPort.GetItems(refnum);
 }
 
 /*!
@@ -206,7 +314,7 @@ const jack_int_t* JackConnectionManager::GetInputPorts(int refnum)
 */
 const jack_int_t* JackConnectionManager::GetOutputPorts(int refnum)
 {
-    return fOutputPort[refnum].GetItems();
+    return fOutputPort.GetItems(refnum);
 }
 
 /*!
@@ -214,10 +322,12 @@ const jack_int_t* JackConnectionManager::GetOutputPorts(int refnum)
 */
 void JackConnectionManager::InitRefNum(int refnum)
 {
-    fInputPort[refnum].Init();
-    fOutputPort[refnum].Init();
+    fInputPort.Init(refnum);
+    fOutputPort.Init(refnum);
     fConnectionRef.Init(refnum);
-    fInputCounter[refnum].SetValue(0);
+    fStage[refnum] = 0;
+    fMixPortCount[refnum] = 0;
+    UpdateGraph();
 }
 
 /*!
@@ -225,10 +335,14 @@ void JackConnectionManager::InitRefNum(int refnum)
 */
 void JackConnectionManager::ResetGraph(JackClientTiming* timing)
 {
+    const jack_int_t* active_ref = fActiveRefNum.GetItems();
+    jack_int_t ref;
+
     // Reset activation counter : must be done *before* starting to resume clients
-    for (int i = 0; i < CLIENT_NUM; i++) {
-        fInputCounter[i].Reset();
-        timing[i].fStatus = NotTriggered;
+    for (int i = 0; (i < CLIENT_NUM) && ((ref = active_ref[i]) != EMPTY); i++) {
+        fInputCounter[ref].Reset();
+        timing[ref].fStatus = NotTriggered;
+        timing[ref].fWakeClaim = 0;
     }
 }
 
@@ -246,76 +360,206 @@ int JackConnectionManager::SuspendRefNum(JackClientControl* control, JackSynchro
 }
 
 /*!
-\brief Signal clients connected to the given client.
+\brief Mark a client running without waiting, when it is run on another thread than its own.
 */
-int JackConnectionManager::ResumeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing)
+int JackConnectionManager::AwakeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph)
+{
+    timing[control->fRefNum].fStatus = Running;
+    timing[control->fRefNum].fAwakeAt = GetMicroSeconds();
+    return WakeAssigned(control, table, timing, graph);
+}
+
+/*!
+\brief Once woken as part of a tree, wake the clients assigned to the given refnum, unless its waker already did.
+*/
+int JackConnectionManager::WakeAssigned(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph)
+{
+    int refnum = control->fRefNum;
+    return (fWakeSource[refnum] != EMPTY && CAS(0, 1, &timing[refnum].fWakeClaim))
+        ? WakeRange(fWakeSource[refnum], fWakeBegin[refnum], fWakeEnd[refnum], control, table, timing, graph, timing[refnum].fAwakeAt)
+        : 0;
+}
+
+int JackConnectionManager::ResumeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph)
 {
     jack_time_t current_date = GetMicroSeconds();
-    const jack_int_t* output_ref = fConnectionRef.GetItems(control->fRefNum);
+    const jack_int_t* output_ref = fSuccessor[control->fRefNum].GetItems();
+    jack_int_t ref;
     int res = 0;
 
     // Update state and timestamp of current client
     timing[control->fRefNum].fStatus = Finished;
     timing[control->fRefNum].fFinishedAt = current_date;
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    // Successors woken as a tree : only wake the roots
+    if (WakeRange(control->fRefNum, 0, fWakeCount[control->fRefNum], control, table, timing, graph, current_date) < 0) {
+        res = -1;
+    }
+
+    // Signal connected clients or drivers
+    for (int i = fWakeCount[control->fRefNum]; (i < CLIENT_NUM) && ((ref = output_ref[i]) != EMPTY); i++) {
+        if (Wake(ref, control, table, timing, graph, current_date) < 0) {
+            res = -1;
+        }
+    }
 
-        // Signal connected clients or drivers
-        if (output_ref[i] > 0) {
+    return res;
+}
 
-            // Update state and timestamp of destination clients
-            timing[i].fStatus = Triggered;
-            timing[i].fSignaledAt = current_date;
+/*!
+\brief Wake a range of the successors of a refnum : each woken successor wakes its own sub-range.
 
-            if (!fInputCounter[i].Signal(table + i, control)) {
-                jack_log("JackConnectionManager::ResumeRefNum error: ref = %ld output = %ld ", control->fRefNum, i);
-                res = -1;
-            }
+A successor still waiting for a driver input would only wake its sub-range once ready : it is woken here instead, unless
+the successor was made ready in the meantime and claimed it first.
+*/
+int JackConnectionManager::WakeRange(int refnum, int begin, int end, JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph, jack_time_t date)
+{
+    const jack_int_t* output_ref = fSuccessor[refnum].GetItems();
+    int res = 0;
+
+    while (begin < end) {
+        jack_int_t ref = output_ref[begin];
+        bool ready;
+        if (Wake(ref, control, table, timing, graph, date, &ready) < 0) {
+            res = -1;
+        }
+        if (!ready && CAS(0, 1, &timing[ref].fWakeClaim)
+            && WakeRange(refnum, fWakeBegin[ref], fWakeEnd[ref], control, table, timing, graph, date) < 0) {
+            res = -1;
         }
+        begin = fWakeEnd[ref];
     }
 
     return res;
 }
 
-static bool HasNoConnection(jack_int_t* table)
+int JackConnectionManager::Wake(int refnum, JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph, jack_time_t date, bool* ready)
 {
-    for (int ref = 0; ref < CLIENT_NUM; ref++) {
-        if (table[ref] > 0) return false;
+    // Update state and timestamp of destination clients
+    timing[refnum].fStatus = Triggered;
+    timing[refnum].fSignaledAt = date;
+
+    bool res = fInputCounter[refnum].Trigger(control);
+    if (ready) {
+        *ready = res;
+    }
+    if (!res) {
+        return 0;
+    }
+
+    // All inputs are finished : mix them here, the client just reads the result
+    if (fMixPortCount[refnum] > 0) {
+        graph->MixInputPorts(this, refnum);
+        timing[refnum].fMixedAt = GetMicroSeconds();
+    }
+
+    // Server side : internal clients may be run by the worker pool instead of their own thread
+    if (JackGlobals::fDispatchRefNum && JackGlobals::fDispatchRefNum(refnum)) {
+        return 0;
+    }
+
+    if (!table[refnum].Signal()) {
+        jack_log("JackConnectionManager::ResumeRefNum error: ref = %ld output = %ld ", control->fRefNum, refnum);
+        return -1;
+    }
+    return 0;
+}
+
+/*!
+\brief Whether an input port is mixed before its client is woken, the graph manager knows the connected ports clients.
+*/
+void JackConnectionManager::SetMixPort(int refnum, jack_port_id_t port_index, bool mix)
+{
+    if (fMixPort[port_index] != mix) {
+        jack_log("JackConnectionManager::SetMixPort ref = %ld port_index = %ld mix = %ld", refnum, port_index, mix);
+        fMixPort[port_index] = mix;
+        fMixPortCount[refnum] += (mix) ? 1 : -1;
     }
-    return true;
 }
 
 // Using http://en.wikipedia.org/wiki/Topological_sorting
 
-void JackConnectionManager::TopologicalSort(std::vector<jack_int_t>& sorted)
+void JackConnectionManager::TopologicalSort(std::vector<jack_int_t>& sorted) const
 {
-    JackFixedMatrix<CLIENT_NUM>* tmp = new JackFixedMatrix<CLIENT_NUM>;
-    std::set<jack_int_t> level;
+    // Kept on the stack : the sort is done on each graph change
+    jack_int_t input_count[CLIENT_NUM];
+    bool ready[CLIENT_NUM];
+    bool visited[CLIENT_NUM];
 
-    fConnectionRef.Copy(*tmp);
+    for (int ref = 0; ref < CLIENT_NUM; ref++) {
+        input_count[ref] = 0;
+        ready[ref] = false;
+        visited[ref] = false;
+    }
+    for (int ref1 = 0; ref1 < CLIENT_NUM; ref1++) {
+        const jack_int_t* output_ref = fConnectionRef.GetItems(ref1);
+        for (int ref2 = 0; ref2 < CLIENT_NUM; ref2++) {
+            if (output_ref[ref2] > 0) {
+                input_count[ref2]++;
+            }
+        }
+    }
 
     // Inputs of the graph
-    level.insert(AUDIO_DRIVER_REFNUM);
-    level.insert(FREEWHEEL_DRIVER_REFNUM);
-
-    while (level.size() > 0) {
-        jack_int_t refnum = *level.begin();
+    ready[AUDIO_DRIVER_REFNUM] = true;
+    ready[FREEWHEEL_DRIVER_REFNUM] = true;
+
+    // Always take the lowest ready refnum first
+    for (int refnum = 0; refnum < CLIENT_NUM; ) {
+        if (!ready[refnum]) {
+            refnum++;
+            continue;
+        }
         sorted.push_back(refnum);
-        level.erase(level.begin());
-        const jack_int_t* output_ref1 = tmp->GetItems(refnum);
+        ready[refnum] = false;
+        // Drivers are ready again once their inputs are done, their outputs are only released once
+        if (visited[refnum]) {
+            continue;
+        }
+        visited[refnum] = true;
+        const jack_int_t* output_ref = fConnectionRef.GetItems(refnum);
+        int next = refnum;
         for (int dst = 0; dst < CLIENT_NUM; dst++) {
-            if (output_ref1[dst] > 0) {
-                tmp->ClearItem(refnum, dst);
-                jack_int_t output_ref2[CLIENT_NUM];
-                tmp->GetOutputTable1(dst, output_ref2);
-                if (HasNoConnection(output_ref2)) {
-                    level.insert(dst);
+            if (output_ref[dst] > 0 && --input_count[dst] == 0) {
+                ready[dst] = true;
+                next = (dst < next) ? dst : next;
+            }
+        }
+        refnum = next;
+    }
+}
+
+/*!
+\brief Extend the clients whose latency changed to the ones depending on them : downstream for capture latency, upstream for playback latency.
+
+Latencies are not propagated through drivers, their ports latency is set by the driver itself.
+*/
+void JackConnectionManager::PropagateLatency(const std::vector<jack_int_t>& sorted, bool* capture, bool* playback) const
+{
+    std::vector<jack_int_t>::const_iterator it;
+    std::vector<jack_int_t>::const_reverse_iterator rit;
+    int driver_num = GetEngineControl()->fDriverNum;
+
+    for (it = sorted.begin(); it != sorted.end(); it++) {
+        if (capture[*it] && *it >= driver_num) {
+            const jack_int_t* output_ref = fConnectionRef.GetItems(*it);
+            for (int dst = 0; dst < CLIENT_NUM; dst++) {
+                if (output_ref[dst] > 0 && dst != FREEWHEEL_DRIVER_REFNUM) {
+                    capture[dst] = true;
                 }
             }
         }
     }
 
-    delete tmp;
+    for (rit = sorted.rbegin(); rit != sorted.rend(); rit++) {
+        if (playback[*rit] && *rit >= driver_num) {
+            for (int src = 0; src < CLIENT_NUM; src++) {
+                if (fConnectionRef.GetItemCount(src, *rit) > 0 && src != FREEWHEEL_DRIVER_REFNUM) {
+                    playback[src] = true;
+                }
+            }
+        }
+    }
 }
 
 /*!
@@ -355,8 +599,9 @@ void JackConnectionManager::DirectConnect(int ref1, int ref2)
 
     if (fConnectionRef.IncItem(ref1, ref2) == 1) { // First connection between client ref1 and client ref2
         jack_log("JackConnectionManager::DirectConnect first: ref1 = %ld ref2 = %ld", ref1, ref2);
-        fInputCounter[ref2].IncValue();
     }
+
+    UpdateGraph();
 }
 
 /*!
@@ -368,8 +613,209 @@ void JackConnectionManager::DirectDisconnect(int ref1, int ref2)
 
     if (fConnectionRef.DecItem(ref1, ref2) == 0) { // Last connection between client ref1 and client ref2
         jack_log("JackConnectionManager::DirectDisconnect last: ref1 = %ld ref2 = %ld", ref1, ref2);
-        fInputCounter[ref2].DecValue();
     }
+
+    UpdateGraph();
+}
+
+/*!
+\brief Update the RT view of the graph after a change in fConnectionRef.
+*/
+void JackConnectionManager::UpdateGraph()
+{
+    if (GetEngineControl()->fPipelineStages > 1) {
+        UpdatePipeline(GetEngineControl()->fPipelineStages);
+    } else {
+        UpdateActivation();
+    }
+}
+
+/*!
+\brief Rebuild the activation counters, the successor lists and the list of refnums taking part in activation.
+
+Done when the graph changes, so that the RT code only visits actual connections.
+*/
+void JackConnectionManager::UpdateActivation()
+{
+    int driver_num = GetEngineControl()->fDriverNum;
+    int fanout = GetEngineControl()->fWakeFanout;
+    jack_int_t count[CLIENT_NUM] = { 0 };
+    jack_int_t client_count[CLIENT_NUM] = { 0 };
+    jack_int_t source[CLIENT_NUM];
+
+    fActiveRefNum.Init();
+
+    for (int ref = 0; ref < CLIENT_NUM; ref++) {
+        source[ref] = EMPTY;
+        fWakeSource[ref] = EMPTY;
+    }
+
+    for (int ref1 = 0; ref1 < CLIENT_NUM; ref1++) {
+        const jack_int_t* output_ref = fConnectionRef.GetItems(ref1);
+        for (int ref2 = 0; ref2 < CLIENT_NUM; ref2++) {
+            if (output_ref[ref2] > 0 && !IsDelayedConnection(ref1, ref2)) {
+                count[ref2]++;
+                if (ref1 >= driver_num) {
+                    client_count[ref2]++;
+                    source[ref2] = ref1;
+                }
+            }
+        }
+    }
+
+    // A client can be woken as part of a tree when its other inputs are drivers, which all signal at cycle start:
+    // by its only client input, or by the freewheel driver
+    for (int ref = 0; ref < CLIENT_NUM; ref++) {
+        if (ref < driver_num || client_count[ref] > 1 || source[ref] == ref) {
+            source[ref] = EMPTY;
+        } else if (client_count[ref] == 0) {
+            source[ref] = (fConnectionRef.GetItemCount(FREEWHEEL_DRIVER_REFNUM, ref) > 0) ? FREEWHEEL_DRIVER_REFNUM : EMPTY;
+        }
+    }
+
+    for (int ref1 = 0; ref1 < CLIENT_NUM; ref1++) {
+        const jack_int_t* output_ref = fConnectionRef.GetItems(ref1);
+        fSuccessor[ref1].Init();
+        // Successors woken as a tree come first
+        for (int ref2 = 0; ref2 < CLIENT_NUM; ref2++) {
+            if (output_ref[ref2] > 0 && source[ref2] == ref1) {
+                fSuccessor[ref1].AddItem(ref2);
+            }
+        }
+        fWakeCount[ref1] = fSuccessor[ref1].GetItemCount();
+        for (int ref2 = 0; ref2 < CLIENT_NUM; ref2++) {
+            if (output_ref[ref2] > 0 && source[ref2] != ref1 && !IsDelayedConnection(ref1, ref2)) {
+                fSuccessor[ref1].AddItem(ref2);
+            }
+        }
+        if (fanout > 0 && fWakeCount[ref1] >= fanout) {
+            AssignWakeRange(ref1, 0, fWakeCount[ref1]);
+        } else {
+            fWakeCount[ref1] = 0;
+        }
+    }
+
+    for (int ref = 0; ref < CLIENT_NUM; ref++) {
+        fInputCounter[ref].SetValue(count[ref]);
+        // Drivers are always reset, IsFinishedGraph reads the freewheel driver activation
+        if (ref <= FREEWHEEL_DRIVER_REFNUM || count[ref] > 0 || fSuccessor[ref].GetItemCount() > 0) {
+            fActiveRefNum.AddItem(ref);
+        }
+    }
+}
+
+/*!
+\brief Split a range of the successors of a refnum in a binomial tree.
+
+The first successor of the range wakes the first half of the rest, the caller goes on with the second half.
+*/
+void JackConnectionManager::AssignWakeRange(int refnum, int begin, int end)
+{
+    const jack_int_t* output_ref = fSuccessor[refnum].GetItems();
+
+    while (begin < end) {
+        jack_int_t ref = output_ref[begin];
+        int half = begin + 1 + (end - begin - 1) / 2;
+        fWakeSource[ref] = refnum;
+        fWakeBegin[ref] = begin + 1;
+        fWakeEnd[ref] = half;
+        AssignWakeRange(refnum, begin + 1, half);
+        begin = half;
+    }
+}
+
+/*!
+\brief Give a delayed buffer to each output port connected to another pipeline stage, false if there are not enough.
+*/
+bool JackConnectionManager::AllocateDelaySlots()
+{
+    for (int ref1 = 0; ref1 < CLIENT_NUM; ref1++) {
+        const jack_int_t* output_ports = fOutputPort.GetItems(ref1);
+        jack_int_t port_index;
+
+        for (int i = 0; (i < PORT_NUM_FOR_CLIENT) && ((port_index = output_ports[i]) != EMPTY); i++) {
+            const jack_int_t* connections = fConnection.GetItems(port_index);
+            jack_int_t dst_index;
+
+            for (int j = 0; (j < CONNECTION_NUM_FOR_PORT) && ((dst_index = connections[j]) != EMPTY); j++) {
+                int ref2 = GetInputRefNum(dst_index);
+                if (ref2 >= 0 && (IsDelayedConnection(ref1, ref2) || IsStageFeedbackConnection(ref1, ref2))) {
+                    if (fDelayPortCount == PIPELINE_BUFFER_NUM) {
+                        ReleaseDelaySlots();
+                        return false;
+                    }
+                    fDelaySlot[port_index] = fDelayPortCount;
+                    fDelayPort[fDelayPortCount++] = port_index;
+                    break;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void JackConnectionManager::ReleaseDelaySlots()
+{
+    for (int slot = 0; slot < fDelayPortCount; slot++) {
+        fDelaySlot[fDelayPort[slot]] = EMPTY;
+    }
+    fDelayPortCount = 0;
+}
+
+/*!
+\brief Partition the clients in pipeline stages by graph depth, and update the activation counters accordingly.
+
+A client stage only depends of its longest path from the graph inputs, so that all connections go to the same or a later stage.
+When there are not enough delayed buffers for all connections between stages, less stages are used.
+*/
+void JackConnectionManager::UpdatePipeline(int stages)
+{
+    int driver_num = GetEngineControl()->fDriverNum;
+    jack_int_t level[CLIENT_NUM];
+    jack_int_t max_level = 0;
+    int requested = stages;
+
+    // Longest path between clients: loops are kept in fLoopFeedback, so at most CLIENT_NUM passes are needed
+    for (int ref = 0; ref < CLIENT_NUM; ref++) {
+        level[ref] = 0;
+    }
+
+    for (int pass = 0; pass < CLIENT_NUM; pass++) {
+        bool changed = false;
+        for (int ref1 = driver_num; ref1 < CLIENT_NUM; ref1++) {
+            for (int ref2 = driver_num; ref2 < CLIENT_NUM; ref2++) {
+                if (ref1 != ref2 && fConnectionRef.GetItemCount(ref1, ref2) > 0 && level[ref2] <= level[ref1]) {
+                    level[ref2] = level[ref1] + 1;
+                    max_level = std::max(max_level, level[ref2]);
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+
+    ReleaseDelaySlots();
+
+    for (; stages >= 1; stages--) {
+        for (int ref = 0; ref < CLIENT_NUM; ref++) {
+            fStage[ref] = (ref < driver_num) ? -1 : (level[ref] * stages) / (max_level + 1);
+        }
+        if (AllocateDelaySlots()) {
+            break;
+        }
+    }
+
+    if (stages < requested) {
+        jack_info("Not enough pipeline buffers, graph executed in %d stage(s) instead of %d", stages, requested);
+    }
+
+    // Connections between stages do not take part in activation
+    UpdateActivation();
+
+    jack_log("JackConnectionManager::UpdatePipeline stages = %ld delayed ports = %ld", stages, fDelayPortCount);
 }
 
 /*!
@@ -387,7 +833,7 @@ bool JackConnectionManager::IsDirectConnection(int ref1, int ref2) const
 int JackConnectionManager::GetInputRefNum(jack_port_id_t port_index) const
 {
     for (int i = 0; i < CLIENT_NUM; i++) {
-        if (fInputPort[i].CheckItem(port_index)) {
+        if (fInputPort.CheckItem(i, port_index)) {
             return i;
         }
     }
@@ -401,7 +847,7 @@ int JackConnectionManager::GetInputRefNum(jack_port_id_t port_index) const
 int JackConnectionManager::GetOutputRefNum(jack_port_id_t port_index) const
 {
     for (int i = 0; i < CLIENT_NUM; i++) {
-        if (fOutputPort[i].CheckItem(port_index)) {
+        if (fOutputPort.CheckItem(i, port_index)) {
             return i;
         }
     }
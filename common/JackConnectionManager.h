@@ -25,12 +25,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackError.h"
 #include "JackCompilerDeps.h"
 #include <vector>
+#include <type_traits>
 #include <assert.h>
 
 namespace Jack
 {
 
 struct JackClientControl;
+class JackGraphManager;
 
 /*!
 \brief Utility class.
@@ -156,6 +158,164 @@ class JackFixedArray1 : public JackFixedArray<SIZE>
 
 } POST_PACKED_STRUCTURE;
 
+/*!
+\brief No value attached to the items of JackPackedLists.
+*/
+
+struct JackNoValue
+{};
+
+/*!
+\brief Utility class : LIST_NUM lists of at most LIST_SIZE items, packed one after the other in a table of ITEM_NUM items.
+
+Each list is followed by an EMPTY item, so that it can be read like a JackFixedArray. Adding or removing an item moves
+the following lists. Only the used part of the table is copied, and only when the lists have changed since the copy
+they were made from. A VALUE can be attached to each item, it is moved and copied along with the item.
+*/
+
+PRE_PACKED_STRUCTURE
+template <int LIST_NUM, int LIST_SIZE, int ITEM_NUM, typename VALUE = JackNoValue>
+class JackPackedLists
+{
+
+    private:
+
+        static const int VALUE_NUM = std::is_empty<VALUE>::value ? 1 : LIST_NUM + ITEM_NUM + LIST_SIZE;
+
+        UInt32 fBegin[LIST_NUM + 1];                        // First item of each list, fBegin[LIST_NUM] is the used size
+        jack_int_t fTable[LIST_NUM + ITEM_NUM + LIST_SIZE]; // Always EMPTY tail : bounded reads of the last lists stay in the table
+        VALUE fValue[VALUE_NUM];                            // Value of each item, not stored for JackNoValue
+        bool fChanged;
+
+        void MoveItems(int pos, int offset, int list)
+        {
+            int end = fBegin[LIST_NUM];
+            memmove(&fTable[pos + offset], &fTable[pos], (end - pos) * sizeof(jack_int_t));
+            if (VALUE_NUM > 1) {
+                memmove(&fValue[pos + offset], &fValue[pos], (end - pos) * sizeof(VALUE));
+            }
+            // Items left behind when moving down
+            for (int i = end + offset; i < end; i++) {
+                fTable[i] = EMPTY;
+            }
+            for (int i = list + 1; i <= LIST_NUM; i++) {
+                fBegin[i] += offset;
+            }
+            fChanged = true;
+        }
+
+    public:
+
+        JackPackedLists()
+        {
+            for (int i = 0; i <= LIST_NUM; i++) {
+                fBegin[i] = i;
+            }
+            for (int i = 0; i < LIST_NUM + ITEM_NUM + LIST_SIZE; i++) {
+                fTable[i] = EMPTY;
+            }
+            fChanged = false;
+        }
+
+        void Init(int list)
+        {
+            int count = GetItemCount(list);
+            if (count > 0) {
+                MoveItems(fBegin[list + 1] - 1, -count, list);
+            }
+        }
+
+        bool AddItem(int list, jack_int_t index)
+        {
+            int pos = fBegin[list + 1] - 1; // EMPTY ending the list
+            if (pos - int(fBegin[list]) >= LIST_SIZE || fBegin[LIST_NUM] >= UInt32(LIST_NUM + ITEM_NUM)) {
+                return false;
+            }
+            MoveItems(pos, 1, list);
+            fTable[pos] = index;
+            if (VALUE_NUM > 1) {
+                fValue[pos] = VALUE();
+            }
+            return true;
+        }
+
+        bool RemoveItem(int list, jack_int_t index)
+        {
+            int pos = FindItem(list, index);
+            if (pos >= 0) {
+                MoveItems(fBegin[list] + pos + 1, -1, list);
+                return true;
+            }
+            return false;
+        }
+
+        /*!
+        	\brief Position of an item in the list, -1 if not found.
+        */
+        int FindItem(int list, jack_int_t index) const
+        {
+            for (UInt32 i = fBegin[list]; i < fBegin[list + 1] - 1; i++) {
+                if (fTable[i] == index)
+                    return i - fBegin[list];
+            }
+            return -1;
+        }
+
+        jack_int_t GetItem(int list, int index) const
+        {
+            return (index < GetItemCount(list)) ? fTable[fBegin[list] + index] : EMPTY;
+        }
+
+        const jack_int_t* GetItems(int list) const
+        {
+            return &fTable[fBegin[list]];
+        }
+
+        bool CheckItem(int list, jack_int_t index) const
+        {
+            return FindItem(list, index) >= 0;
+        }
+
+        VALUE GetValue(int list, int pos) const
+        {
+            return fValue[fBegin[list] + pos];
+        }
+
+        void SetValue(int list, int pos, const VALUE& value)
+        {
+            fValue[fBegin[list] + pos] = value;
+            fChanged = true;
+        }
+
+        int GetItemCount(int list) const
+        {
+            return fBegin[list + 1] - fBegin[list] - 1;
+        }
+
+        void SetChanged()
+        {
+            fChanged = true;
+        }
+
+        /*!
+        	\brief Copy the lists, the current content being the one the copied lists were made from.
+        */
+        void Copy(const JackPackedLists& src)
+        {
+            if (src.fChanged) {
+                // Also clears the items beyond the copied used size
+                UInt32 size = (fBegin[LIST_NUM] > src.fBegin[LIST_NUM]) ? fBegin[LIST_NUM] : src.fBegin[LIST_NUM];
+                memcpy(fBegin, src.fBegin, sizeof(fBegin));
+                memcpy(fTable, src.fTable, size * sizeof(jack_int_t));
+                if (VALUE_NUM > 1) {
+                    memcpy(fValue, src.fValue, size * sizeof(VALUE));
+                }
+            }
+            fChanged = false;
+        }
+
+} POST_PACKED_STRUCTURE;
+
 /*!
 \brief Utility class.
 */
@@ -368,6 +528,8 @@ class JackLoopFeedback
 
 /*!
 \brief For client timing measurements.
+
+Written by the client itself and by the clients or driver signaling it, each one fills a cache line.
 */
 
 PRE_PACKED_STRUCTURE
@@ -376,10 +538,14 @@ struct JackClientTiming
     jack_time_t fSignaledAt;
     jack_time_t fAwakeAt;
     jack_time_t fFinishedAt;
+    jack_time_t fMixedAt;
     jack_client_state_t fStatus;
+    volatile UInt32 fWakeClaim;     // Set by the first of the client and its waker to wake its part of a wake tree
+    char fPadding[JACK_CACHE_LINE_SIZE - 4 * sizeof(jack_time_t) - sizeof(jack_client_state_t) - sizeof(UInt32)];
 
     JackClientTiming()
     {
+        static_assert(sizeof(JackClientTiming) == JACK_CACHE_LINE_SIZE, "JackClientTiming must fill a cache line");
         Init();
     }
     ~JackClientTiming()
@@ -390,21 +556,68 @@ struct JackClientTiming
         fSignaledAt = 0;
         fAwakeAt = 0;
         fFinishedAt = 0;
+        fMixedAt = 0;
         fStatus = NotTriggered;
+        fWakeClaim = 0;
     }
 
 } POST_PACKED_STRUCTURE;
 
+/*!
+\brief Gain of a connection, applied when the input port mixes its connections.
+
+fPrevGain is the gain in the previous graph state : the gain is ramped from it during the first mix with the new state.
+*/
+
+PRE_PACKED_STRUCTURE
+struct JackConnectionGain
+{
+    float fGain;
+    float fPrevGain;
+
+    JackConnectionGain(): fGain(1.f), fPrevGain(1.f)
+    {}
+
+} POST_PACKED_STRUCTURE;
+
 /*!
 \brief Connection manager.
 
 <UL>
-<LI>The <B>fConnection</B> array contains the list (array line) of connected ports for a given port.
-<LI>The <B>fInputPort</B> array contains the list (array line) of input connected  ports for a given client.
-<LI>The <B>fOutputPort</B> array contains the list (array line) of output connected  ports for a given client.
+<LI>The <B>fConnection</B> packed lists contain the list of connected ports for a given port.
+<LI>The <B>fInputPort</B> packed lists contain the list of input connected  ports for a given client.
+<LI>The <B>fOutputPort</B> packed lists contain the list of output connected  ports for a given client.
 <LI>The <B>fConnectionRef</B> array contains the number of ports connected between two clients.
 <LI>The <B>fInputCounter</B> array contains the number of input clients connected to a given for activation purpose.
+<LI>The <B>fSuccessor</B> array contains the list of clients to signal when a given client is finished, built from fConnectionRef.
+<LI>The <B>fActiveRefNum</B> array contains the list of refnums taking part in activation, reset at each cycle.
+<LI>The <B>fStage</B> array contains the pipeline stage of a given client, when the graph is executed in pipelined mode.
+<LI>The <B>fDelaySlot</B> array contains the delayed buffer used by a given output port connected to another stage.
+<LI>The <B>fWakeCount</B> array contains the number of successors of a given client that are woken as a tree, listed first in fSuccessor.
+<LI>The <B>fWakeSource</B>, <B>fWakeBegin</B> and <B>fWakeEnd</B> arrays contain the range of fSuccessor[fWakeSource] a given client wakes when it is itself woken.
+<LI>The <B>fMixPort</B> array tells if a given input port is mixed before its client is woken, <B>fMixPortCount</B> counts them per refnum.
+<LI>The <B>fBusPort</B> array tells if a given input port applies the gains of its connections, kept with them in fConnection.
+<LI>The <B>fGainIndex</B> array contains the graph state index in which the gains of a given input port last changed.
 </UL>
+
+In pipelined mode, clients are partitioned in stages following the graph order. A connection from a client to a
+client of a later stage does not take part in activation: both clients run in the same cycle, the later one reading the
+output of the previous cycle from a delayed buffer. The connection is thus delayed by one period.
+
+When a client is the only client input of many others, signaling all of them serially costs one system call each on its
+thread. Above the "wake-fanout" threshold, it only wakes a few of them, and each woken client first wakes part of the
+remaining ones before running: the set is woken as a binomial tree, in a logarithmic number of steps. A client not made
+ready by the trigger, still waiting for a driver, does not hold back its part of the tree: the waker wakes it instead.
+
+In "server-mix" mode, the input ports of a client connected to several outputs of other clients are mixed by the thread
+that makes the client ready, once all its inputs are finished: the client then reads the mixed buffer without any work.
+
+An input port becomes a summing bus once a gain is set on one of its connections: its connections are then always mixed,
+each one with its gain, including a single one. A gain change is ramped over the first cycle of the graph state it is
+made in, to avoid zipper noise.
+
+Port lists are packed in tables sized for the whole graph instead of one fixed array per port, and are only copied
+when they have changed, when the next state is prepared from the current one.
 */
 
 PRE_PACKED_STRUCTURE
@@ -413,20 +626,49 @@ class SERVER_EXPORT JackConnectionManager
 
     private:
 
-        JackFixedArray<CONNECTION_NUM_FOR_PORT> fConnection[PORT_NUM_MAX];  /*! Connection matrix: list of connected ports for a given port: needed to compute Mix buffer */
-        JackFixedArray1<PORT_NUM_FOR_CLIENT> fInputPort[CLIENT_NUM];	/*! Table of input port per refnum : to find a refnum for a given port */
-        JackFixedArray<PORT_NUM_FOR_CLIENT> fOutputPort[CLIENT_NUM];	/*! Table of output port per refnum : to find a refnum for a given port */
         JackFixedMatrix<CLIENT_NUM> fConnectionRef;						/*! Table of port connections by (refnum , refnum) */
-        alignas(UInt32) alignas(JackActivationCount) JackActivationCount fInputCounter[CLIENT_NUM];	/*! Activation counter per refnum */
+        alignas(JACK_CACHE_LINE_SIZE) JackActivationCount fInputCounter[CLIENT_NUM];	/*! Activation counter per refnum, one cache line each */
         JackLoopFeedback<CONNECTION_NUM_FOR_PORT> fLoopFeedback;		/*! Loop feedback connections */
+        jack_int_t fStage[CLIENT_NUM];                                  /*! Pipeline stage per refnum, -1 for drivers */
+        jack_int_t fDelaySlot[PORT_NUM_MAX];                            /*! Delayed buffer slot per output port, EMPTY if not delayed */
+        jack_int_t fDelayPort[PIPELINE_BUFFER_NUM];                     /*! Output port per delayed buffer slot */
+        jack_int_t fDelayPortCount;
+        JackFixedArray<CLIENT_NUM> fSuccessor[CLIENT_NUM];              /*! Clients to signal when a given refnum is finished */
+        JackFixedArray<CLIENT_NUM> fActiveRefNum;                       /*! Refnums taking part in activation */
+        jack_int_t fWakeCount[CLIENT_NUM];                              /*! Successors woken as a tree, first in fSuccessor */
+        jack_int_t fWakeSource[CLIENT_NUM];                             /*! Refnum whose successors a given client wakes, EMPTY if none */
+        jack_int_t fWakeBegin[CLIENT_NUM];                              /*! Range of fSuccessor[fWakeSource] woken by a given client */
+        jack_int_t fWakeEnd[CLIENT_NUM];
+        bool fMixPort[PORT_NUM_MAX];                                    /*! Input ports mixed before their client is woken */
+        jack_int_t fMixPortCount[CLIENT_NUM];                           /*! Number of such ports per refnum */
+        bool fBusPort[PORT_NUM_MAX];                                    /*! Input ports applying the gains of their connections */
+        UInt16 fGainIndex[PORT_NUM_MAX];                                /*! Graph state index of the last gain change per input port */
+        // Packed lists last : only their used and changed part is copied with the state
+        JackPackedLists<PORT_NUM_MAX, CONNECTION_NUM_FOR_PORT, 2 * CONNECTION_NUM, JackConnectionGain> fConnection;    /*! List of connected ports for a given port: needed to compute Mix buffer */
+        JackPackedLists<CLIENT_NUM, PORT_NUM_FOR_CLIENT, PORT_NUM_MAX> fInputPort;                 /*! Table of input port per refnum : to find a refnum for a given port */
+        JackPackedLists<CLIENT_NUM, PORT_NUM_FOR_CLIENT, PORT_NUM_MAX> fOutputPort;                /*! Table of output port per refnum : to find a refnum for a given port */
 
         bool IsLoopPathAux(int ref1, int ref2) const;
+        void UpdateActivation();
+        void UpdateGraph();
+        void AssignWakeRange(int refnum, int begin, int end);
+        int WakeRange(int refnum, int begin, int end, JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph, jack_time_t date);
+        int Wake(int refnum, JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph, jack_time_t date, bool* ready = NULL);
+        bool AllocateDelaySlots();
+        void ReleaseDelaySlots();
 
     public:
 
         JackConnectionManager();
         ~JackConnectionManager();
 
+        // Heap instances keep the cache line alignment of the activation counters
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
+        void Copy(const JackConnectionManager& src);
+        void SetChanged();
+
         // Connections management
         int Connect(jack_port_id_t port_src, jack_port_id_t port_dst);
         int Disconnect(jack_port_id_t port_src, jack_port_id_t port_dst);
@@ -437,13 +679,13 @@ class SERVER_EXPORT JackConnectionManager
         */
         jack_int_t Connections(jack_port_id_t port_index) const
         {
-            return fConnection[port_index].GetItemCount();
+            return fConnection.GetItemCount(port_index);
         }
 
         jack_port_id_t GetPort(jack_port_id_t port_index, int connection) const
         {
             assert(connection < CONNECTION_NUM_FOR_PORT);
-            return (jack_port_id_t)fConnection[port_index].GetItem(connection);
+            return (jack_port_id_t)fConnection.GetItem(port_index, connection);
         }
 
         const jack_int_t* GetConnections(jack_port_id_t port_index) const;
@@ -481,14 +723,97 @@ class SERVER_EXPORT JackConnectionManager
             return fInputCounter[refnum].GetValue();
         }
 
+        // Pipelined execution
+        void UpdatePipeline(int stages);
+
+        jack_int_t GetStage(int refnum) const
+        {
+            return fStage[refnum];
+        }
+
+        /*!
+          \brief Test if the connections from client ref1 to client ref2 are delayed by one period.
+        */
+        bool IsDelayedConnection(int ref1, int ref2) const
+        {
+            return (fStage[ref1] >= 0 && fStage[ref1] < fStage[ref2]);
+        }
+
+        /*!
+          \brief Test if the connections from client ref1 to client ref2 go back to an earlier stage.
+
+          Only feedback connections do : as in non pipelined mode they read the previous cycle output, but from a delayed
+          buffer since both clients may run at the same time.
+        */
+        bool IsStageFeedbackConnection(int ref1, int ref2) const
+        {
+            return (fStage[ref2] >= 0 && fStage[ref2] < fStage[ref1]);
+        }
+
+        jack_int_t GetDelaySlot(jack_port_id_t port_index) const
+        {
+            return fDelaySlot[port_index];
+        }
+
+        jack_int_t GetDelayPortCount() const
+        {
+            return fDelayPortCount;
+        }
+
+        jack_port_id_t GetDelayPort(int slot) const
+        {
+            return (jack_port_id_t)fDelayPort[slot];
+        }
+
+        // Server side mix
+        void SetMixPort(int refnum, jack_port_id_t port_index, bool mix);
+
+        bool IsMixPort(jack_port_id_t port_index) const
+        {
+            return fMixPort[port_index];
+        }
+
+        // Summing bus
+        int SetGain(jack_port_id_t port_src, jack_port_id_t port_dst, float gain, UInt16 index);
+        int GetGain(jack_port_id_t port_src, jack_port_id_t port_dst, float* gain) const;
+
+        bool IsBusPort(jack_port_id_t port_index) const
+        {
+            return fBusPort[port_index];
+        }
+
+        /*!
+          \brief Gain of the connection at pos of an input port, in the GetConnections order.
+        */
+        JackConnectionGain GetGainAt(jack_port_id_t port_index, int pos) const
+        {
+            return fConnection.GetValue(port_index, pos);
+        }
+
+        UInt16 GetGainIndex(jack_port_id_t port_index) const
+        {
+            return fGainIndex[port_index];
+        }
+
         // Graph
         void ResetGraph(JackClientTiming* timing);
-        int ResumeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing);
+        int ResumeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph);
         int SuspendRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, long time_out_usec);
-        void TopologicalSort(std::vector<jack_int_t>& sorted);
+        int WakeAssigned(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph);
+        int AwakeRefNum(JackClientControl* control, JackSynchro* table, JackClientTiming* timing, JackGraphManager* graph);
+        void TopologicalSort(std::vector<jack_int_t>& sorted) const;
+        void PropagateLatency(const std::vector<jack_int_t>& sorted, bool* capture, bool* playback) const;
 
 } POST_PACKED_STRUCTURE;
 
+/*!
+\brief Used by JackAtomicState when preparing the next state.
+*/
+inline void JackCopyState(JackConnectionManager* dst, const JackConnectionManager* src)
+{
+    dst->Copy(*src);
+}
+
 } // end of namespace
 
 #endif
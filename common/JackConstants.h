@@ -39,6 +39,11 @@
 
 #define SYNC_MAX_NAME_SIZE 256
 
+#define JACK_CACHE_LINE_SIZE 64    // Per-client RT state written by different CPUs is padded to avoid false sharing
+
+#define JACK_CPU_LIST_SIZE 128      // CPU list like "2-3,6" used for thread affinity
+#define JACK_CPU_LIST_MAX 256       // Max number of CPUs in a parsed CPU list
+
 #define REAL_JACK_PORT_NAME_SIZE JACK_CLIENT_NAME_SIZE + JACK_PORT_NAME_SIZE   // full name like "client_name:short_port_name"
 
 #ifndef PORT_NUM
@@ -57,8 +62,18 @@
 
 #define FIRST_AVAILABLE_PORT 1
 
+#define PIPELINE_STAGES_MAX 8       // Max number of stages in pipelined graph execution
+
+#define PIPELINE_BUFFER_NUM 64      // Delayed output buffers shared by all connections between pipeline stages
+
+#define WORKER_THREAD_MAX 64        // Max number of server threads running internal clients
+
 #define CONNECTION_NUM_FOR_PORT PORT_NUM_FOR_CLIENT
 
+#ifndef CONNECTION_NUM
+#define CONNECTION_NUM 16384        // Max number of port connections in the whole graph, whatever the number of ports : connecting fails beyond it
+#endif
+
 #ifndef CLIENT_NUM
 #define CLIENT_NUM 64
 #endif
@@ -70,7 +85,7 @@
 
 #define ALL_CLIENTS -1 // for notification
 
-#define JACK_PROTOCOL_VERSION 9
+#define JACK_PROTOCOL_VERSION 32
 
 #define SOCKET_TIME_OUT 2               // in sec
 #define DRIVER_OPEN_TIMEOUT 5           // in sec
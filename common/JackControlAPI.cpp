@@ -50,6 +50,7 @@
 #include "JackConstants.h"
 #include "JackDriverLoader.h"
 #include "JackServerGlobals.h"
+#include "JackEngineControl.h"
 
 using namespace Jack;
 
@@ -104,6 +105,10 @@ struct jackctl_server
     union jackctl_parameter_value port_max;
     union jackctl_parameter_value default_port_max;
 
+    /* uint32_t, max client number */
+    union jackctl_parameter_value client_max;
+    union jackctl_parameter_value default_client_max;
+
     /* bool */
     union jackctl_parameter_value replace_registry;
     union jackctl_parameter_value default_replace_registry;
@@ -115,6 +120,46 @@ struct jackctl_server
     /* char enum, self connect mode mode */
     union jackctl_parameter_value self_connect_mode;
     union jackctl_parameter_value default_self_connect_mode;
+
+    /* uint32_t, usecs; max time to spin before sleeping on client synchro, if zero, never spin */
+    union jackctl_parameter_value sync_spin;
+    union jackctl_parameter_value default_sync_spin;
+
+    /* string, CPU list for the driver thread */
+    union jackctl_parameter_value driver_cpus;
+    union jackctl_parameter_value default_driver_cpus;
+
+    /* string, CPU list suggested to clients RT threads */
+    union jackctl_parameter_value client_cpus;
+    union jackctl_parameter_value default_client_cpus;
+
+    /* uint32_t, percent of the period reserved to each RT thread with SCHED_DEADLINE, if zero, use SCHED_FIFO */
+    union jackctl_parameter_value deadline;
+    union jackctl_parameter_value default_deadline;
+
+    /* uint32_t, buffer size used in freewheel mode, if zero, keep the current one */
+    union jackctl_parameter_value freewheel_buffer_size;
+    union jackctl_parameter_value default_freewheel_buffer_size;
+
+    /* uint32_t, number of pipeline stages */
+    union jackctl_parameter_value pipeline_stages;
+    union jackctl_parameter_value default_pipeline_stages;
+
+    /* uint32_t, min number of clients woken by the same client to wake them as a tree, if zero, never */
+    union jackctl_parameter_value wake_fanout;
+    union jackctl_parameter_value default_wake_fanout;
+
+    /* uint32_t, number of server threads running internal clients cycles, if zero, internal clients use their own thread */
+    union jackctl_parameter_value internal_workers;
+    union jackctl_parameter_value default_internal_workers;
+
+    /* bool, whether client inputs connected to several outputs are mixed when the client is made ready */
+    union jackctl_parameter_value server_mix;
+    union jackctl_parameter_value default_server_mix;
+
+    /* bool, whether the critical path of the traced cycles is computed */
+    union jackctl_parameter_value trace_analysis;
+    union jackctl_parameter_value default_trace_analysis;
 };
 
 struct jackctl_driver
@@ -990,6 +1035,20 @@ SERVER_EXPORT jackctl_server_t * jackctl_server_create2(
         goto fail_free_parameters;
     }
 
+    value.ui = CLIENT_NUM;
+    if (jackctl_add_parameter(
+          &server_ptr->parameters,
+          "client-max",
+          "Maximum number of clients, drivers included.",
+          "At most the number of clients the server was built for. The engine only visits the refnums in use, so a lower value only limits the number of clients: shared memory is still sized for the built-in maximum.",
+          JackParamUInt,
+          &server_ptr->client_max,
+          &server_ptr->default_client_max,
+          value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
     value.b = false;
     if (jackctl_add_parameter(
             &server_ptr->parameters,
@@ -1035,6 +1094,146 @@ SERVER_EXPORT jackctl_server_t * jackctl_server_create2(
         goto fail_free_parameters;
     }
 
+    value.ui = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "sync-spin",
+            "Max time in microseconds clients spin before sleeping when waiting to be activated (0 = never spin).",
+            "Only used by synchronization backends supporting it (Linux futex). The actual spin time is calibrated from how long upstream clients take to signal, and never exceeds a quarter of the period.",
+            JackParamUInt,
+            &server_ptr->sync_spin,
+            &server_ptr->default_sync_spin,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.str[0] = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "driver-cpus",
+            "CPUs the driver thread is pinned to, like 2-3,6 (empty = no pinning).",
+            "The affinity is set when the thread is created.",
+            JackParamString,
+            &server_ptr->driver_cpus,
+            &server_ptr->default_driver_cpus,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.str[0] = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "client-cpus",
+            "CPUs suggested to clients RT threads, like 4-7 (empty = no pinning).",
+            "Each client is suggested the least used CPU of the list, so that independent graph branches are spread. Clients can override it with jack_set_process_thread_affinity() or the JACK_CLIENT_CPUS environment variable.",
+            JackParamString,
+            &server_ptr->client_cpus,
+            &server_ptr->default_client_cpus,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.ui = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "deadline",
+            "Percent of the period reserved to each RT thread with SCHED_DEADLINE (0 = use SCHED_FIFO).",
+            "Linux only. The reservation is never below the computation time estimated from the buffer size. Threads fall back to SCHED_FIFO when the kernel admission control refuses the reservation, so keep the sum over the driver and clients below the system RT bandwidth (usually 95% per CPU).",
+            JackParamUInt,
+            &server_ptr->deadline,
+            &server_ptr->default_deadline,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.ui = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "freewheel-buffer-size",
+            "Buffer size used in freewheel mode (0 = keep the current one).",
+            "Offline rendering with a larger buffer size than the audio driver one: each cycle, and its synchronization cost, then covers more frames. Clients get a buffer size callback when freewheel mode starts and stops.",
+            JackParamUInt,
+            &server_ptr->freewheel_buffer_size,
+            &server_ptr->default_freewheel_buffer_size,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.ui = 1;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "pipeline-stages",
+            "Number of stages the graph is partitioned in (1 = no pipelining).",
+            "Clients are partitioned in stages following the graph order. Stages run in parallel in the same cycle, each one processing the output of the previous stage in the previous cycle: a deep graph can then use several CPUs, and connections between stages add one period of latency, reported by the latency callbacks.",
+            JackParamUInt,
+            &server_ptr->pipeline_stages,
+            &server_ptr->default_pipeline_stages,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.ui = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "wake-fanout",
+            "Min number of clients woken by the same client to wake them as a tree (0 = never).",
+            "When a client (or the driver) is the only client input of at least this number of clients, it only wakes a few of them, and each woken client wakes part of the others before running: the wake-up system calls are spread over the woken clients threads instead of being serialized on the signaling one.",
+            JackParamUInt,
+            &server_ptr->wake_fanout,
+            &server_ptr->default_wake_fanout,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.ui = 0;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "internal-workers",
+            "Number of RT threads running internal clients (0 = each internal client uses its own thread).",
+            "Internal clients made ready by the driver or by another internal client are run by a pool of server threads instead of waking their own thread: a worker runs the next ready internal client itself, without any context switch, and the others are spread over the idle workers.",
+            JackParamUInt,
+            &server_ptr->internal_workers,
+            &server_ptr->default_internal_workers,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.b = false;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "server-mix",
+            "Mix client inputs connected to several outputs before waking the client.",
+            "An input port connected to several outputs of other clients is mixed by the thread that makes its client ready, once all its inputs are finished, instead of by the client when it asks for the port buffer: the client only reads the mixed buffer, and the mix time is kept apart from the client wake-up and process times.",
+            JackParamBool,
+            &server_ptr->server_mix,
+            &server_ptr->default_server_mix,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
+    value.b = false;
+    if (jackctl_add_parameter(
+            &server_ptr->parameters,
+            "trace-analysis",
+            "Compute the critical path and the clients slack of the traced cycles.",
+            "The server RT thread finds, at each cycle, the client that triggered each client, the clients slack and the critical path of the cycle, stored in the trace ring. It is done by the RT thread and its cost grows with the square of the number of clients, so it is disabled by default: the trace then only holds the clients timing.",
+            JackParamBool,
+            &server_ptr->trace_analysis,
+            &server_ptr->default_trace_analysis,
+            value) == NULL)
+    {
+        goto fail_free_parameters;
+    }
+
     JackServerGlobals::on_device_acquire = on_device_acquire;
     JackServerGlobals::on_device_release = on_device_release;
     JackServerGlobals::on_device_reservation_loop = on_device_reservation_loop;
@@ -1154,12 +1353,51 @@ jackctl_server_open(
             server_ptr->client_timeout.i = 500; /* 0.5 sec; usable when non realtime. */
         }
 
+        /* check CPU lists before allocating server */
+        int cpus[JACK_CPU_LIST_MAX];
+        if (JackTools::ParseCPUList(server_ptr->driver_cpus.str, cpus, JACK_CPU_LIST_MAX) < 0
+            || strlen(server_ptr->driver_cpus.str) >= JACK_CPU_LIST_SIZE) {
+            jack_error("Invalid driver CPU list %s", server_ptr->driver_cpus.str);
+            goto fail_unregister;
+        }
+        if (JackTools::ParseCPUList(server_ptr->client_cpus.str, cpus, JACK_CPU_LIST_MAX) < 0
+            || strlen(server_ptr->client_cpus.str) >= JACK_CPU_LIST_SIZE) {
+            jack_error("Invalid client CPU list %s", server_ptr->client_cpus.str);
+            goto fail_unregister;
+        }
+
+        if (server_ptr->deadline.ui > 100) {
+            jack_error("Jack server started with invalid deadline runtime %u%% (when max can be 100%%)", server_ptr->deadline.ui);
+            goto fail_unregister;
+        }
+
+        if (server_ptr->freewheel_buffer_size.ui > BUFFER_SIZE_MAX
+            || (server_ptr->freewheel_buffer_size.ui & (server_ptr->freewheel_buffer_size.ui - 1)) != 0) {
+            jack_error("Jack server started with invalid freewheel buffer size %u (power of two up to %d)", server_ptr->freewheel_buffer_size.ui, BUFFER_SIZE_MAX);
+            goto fail_unregister;
+        }
+
+        if (server_ptr->pipeline_stages.ui < 1 || server_ptr->pipeline_stages.ui > PIPELINE_STAGES_MAX) {
+            jack_error("Jack server started with invalid pipeline stages %u (from 1 to %d)", server_ptr->pipeline_stages.ui, PIPELINE_STAGES_MAX);
+            goto fail_unregister;
+        }
+
+        if (server_ptr->internal_workers.ui > WORKER_THREAD_MAX) {
+            jack_error("Jack server started with too many internal workers %u (when max can be %d)", server_ptr->internal_workers.ui, WORKER_THREAD_MAX);
+            goto fail_unregister;
+        }
+
         /* check port max value before allocating server */
         if (server_ptr->port_max.ui > PORT_NUM_MAX) {
             jack_error("Jack server started with too much ports %d (when port max can be %d)", server_ptr->port_max.ui, PORT_NUM_MAX);
             goto fail;
         }
 
+        if (server_ptr->client_max.ui < 3 || server_ptr->client_max.ui > CLIENT_NUM) {
+            jack_error("Jack server started with invalid client max %u (from 3 to %d)", server_ptr->client_max.ui, CLIENT_NUM);
+            goto fail_unregister;
+        }
+
         /* get the engine/driver started */
         server_ptr->engine = new JackServer(
             server_ptr->sync.b,
@@ -1171,13 +1409,25 @@ jackctl_server_open(
             server_ptr->verbose.b,
             (jack_timer_type_t)server_ptr->clock_source.ui,
             server_ptr->self_connect_mode.c,
-            server_ptr->name.str);
+            server_ptr->name.str,
+            server_ptr->pipeline_stages.ui);
         if (server_ptr->engine == NULL)
         {
             jack_error("Failed to create new JackServer object");
             goto fail_unregister;
         }
 
+        server_ptr->engine->GetEngineControl()->fSyncSpinUsecs = server_ptr->sync_spin.ui;
+        strcpy(server_ptr->engine->GetEngineControl()->fDriverCPUs, server_ptr->driver_cpus.str);
+        strcpy(server_ptr->engine->GetEngineControl()->fClientCPUs, server_ptr->client_cpus.str);
+        server_ptr->engine->GetEngineControl()->fDeadlineRuntime = server_ptr->deadline.ui;
+        server_ptr->engine->GetEngineControl()->fFreewheelBufferSize = server_ptr->freewheel_buffer_size.ui;
+        server_ptr->engine->GetEngineControl()->fWakeFanout = server_ptr->wake_fanout.ui;
+        server_ptr->engine->GetEngineControl()->fWorkerCount = server_ptr->internal_workers.ui;
+        server_ptr->engine->GetEngineControl()->fServerMix = server_ptr->server_mix.b;
+        server_ptr->engine->GetEngineControl()->fTraceAnalysis = server_ptr->trace_analysis.b;
+        server_ptr->engine->GetEngineControl()->fClientMax = server_ptr->client_max.ui;
+
         if (!jackctl_create_param_list(driver_ptr->parameters, &paramlist)) goto fail_delete;
         rc = server_ptr->engine->Open(driver_ptr->desc_ptr, paramlist);
         jackctl_destroy_param_list(paramlist);
@@ -1529,6 +1779,70 @@ SERVER_EXPORT bool jackctl_server_remove_slave(jackctl_server * server_ptr, jack
     }
 }
 
+SERVER_EXPORT bool jackctl_server_get_sync_spin_stats(jackctl_server * server_ptr, uint32_t * spun_ptr, uint32_t * slept_ptr)
+{
+    if (server_ptr && server_ptr->engine && spun_ptr && slept_ptr) {
+        JackSynchro* table = server_ptr->engine->GetSynchroTable();
+        *spun_ptr = *slept_ptr = 0;
+        for (int i = 0; i < CLIENT_NUM; i++) {
+            unsigned int spun, slept;
+            if (table[i].GetSpinStats(&spun, &slept)) {
+                *spun_ptr += spun;
+                *slept_ptr += slept;
+            }
+        }
+        return true;
+    } else {
+        return false;
+    }
+}
+
+SERVER_EXPORT bool jackctl_server_get_client_timing_stats(jackctl_server * server_ptr, const char * client_name, jack_client_timing_stats_t * stats_ptr)
+{
+    if (server_ptr && server_ptr->engine && client_name && stats_ptr) {
+        return server_ptr->engine->GetEngineControl()->GetClientTimingStats(client_name, stats_ptr);
+    } else {
+        return false;
+    }
+}
+
+SERVER_EXPORT bool jackctl_server_get_driver_wake_histogram(jackctl_server * server_ptr, jack_wake_histogram_t * histogram_ptr)
+{
+    if (server_ptr && server_ptr->engine && histogram_ptr) {
+        return server_ptr->engine->GetEngineControl()->GetDriverWakeHistogram(histogram_ptr);
+    } else {
+        return false;
+    }
+}
+
+SERVER_EXPORT bool jackctl_server_get_driver_early_wake_histogram(jackctl_server * server_ptr, jack_wake_histogram_t * histogram_ptr)
+{
+    if (server_ptr && server_ptr->engine && histogram_ptr) {
+        return server_ptr->engine->GetEngineControl()->GetDriverEarlyWakeHistogram(histogram_ptr);
+    } else {
+        return false;
+    }
+}
+
+SERVER_EXPORT bool jackctl_server_get_client_wake_histogram(jackctl_server * server_ptr, const char * client_name, jack_wake_histogram_t * histogram_ptr)
+{
+    if (server_ptr && server_ptr->engine && client_name && histogram_ptr) {
+        return server_ptr->engine->GetEngineControl()->GetClientWakeHistogram(client_name, histogram_ptr);
+    } else {
+        return false;
+    }
+}
+
+SERVER_EXPORT bool jackctl_server_reset_wake_histograms(jackctl_server * server_ptr)
+{
+    if (server_ptr && server_ptr->engine) {
+        server_ptr->engine->GetEngineControl()->ResetWakeHistograms();
+        return true;
+    } else {
+        return false;
+    }
+}
+
 SERVER_EXPORT bool jackctl_server_switch_master(jackctl_server * server_ptr, jackctl_driver * driver_ptr)
 {
     if (server_ptr && server_ptr->engine) {
@@ -9,6 +9,7 @@
 
 #include "jack/types.h"
 #include "jslist.h"
+#include "jack/statistics.h"
 #include "JackCompilerDeps.h"
 
 /** Parameter types, intentionally similar to jack_driver_param_type_t */
@@ -297,6 +298,32 @@ SERVER_EXPORT bool
 jackctl_server_switch_master(jackctl_server_t * server,
                             jackctl_driver_t * driver);
 
+SERVER_EXPORT bool
+jackctl_server_get_sync_spin_stats(jackctl_server_t * server,
+                            uint32_t * spun,
+                            uint32_t * slept);
+
+SERVER_EXPORT bool
+jackctl_server_get_client_timing_stats(jackctl_server_t * server,
+                            const char * client_name,
+                            jack_client_timing_stats_t * stats);
+
+SERVER_EXPORT bool
+jackctl_server_get_driver_wake_histogram(jackctl_server_t * server,
+                            jack_wake_histogram_t * histogram);
+
+SERVER_EXPORT bool
+jackctl_server_get_driver_early_wake_histogram(jackctl_server_t * server,
+                            jack_wake_histogram_t * histogram);
+
+SERVER_EXPORT bool
+jackctl_server_get_client_wake_histogram(jackctl_server_t * server,
+                            const char * client_name,
+                            jack_wake_histogram_t * histogram);
+
+SERVER_EXPORT bool
+jackctl_server_reset_wake_histograms(jackctl_server_t * server);
+
 SERVER_EXPORT int
 jackctl_parse_driver_params(jackctl_driver * driver_ptr, int argc, char* argv[]);
 
@@ -315,6 +315,13 @@ int JackDebugClient::PortDisconnect(jack_port_id_t src)
     return res;
 }
 
+int JackDebugClient::SetConnectionGain(const char* src, const char* dst, float gain)
+{
+    CheckClient("SetConnectionGain");
+    *fStream << "JackClientDebug : SetConnectionGain " << src << " to " << dst << " gain " << gain << endl;
+    return fClient->SetConnectionGain(src, dst, gain);
+}
+
 int JackDebugClient::PortIsMine(jack_port_id_t port_index)
 {
     CheckClient("PortIsMine");
@@ -555,6 +562,12 @@ int JackDebugClient::SetProcessThread(JackThreadCallback fun, void *arg)
     return fClient->SetProcessThread(fun, arg);
 }
 
+int JackDebugClient::SetProcessThreadAffinity(const char* cpus)
+{
+    CheckClient("SetProcessThreadAffinity");
+    return fClient->SetProcessThreadAffinity(cpus);
+}
+
 jack_session_command_t* JackDebugClient::SessionNotify(const char* target, jack_session_event_type_t type, const char* path)
 {
     CheckClient("SessionNotify");
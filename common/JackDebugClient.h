@@ -94,6 +94,7 @@ class JackDebugClient : public JackClient
         int PortConnect(const char* src, const char* dst);
         int PortDisconnect(const char* src, const char* dst);
         int PortDisconnect(jack_port_id_t src);
+        int SetConnectionGain(const char* src, const char* dst, float gain);
 
         int PortIsMine(jack_port_id_t port_index);
         int PortRename(jack_port_id_t port_index, const char* name);
@@ -134,6 +135,7 @@ class JackDebugClient : public JackClient
 
         // RT Thread
         int SetProcessThread(JackThreadCallback fun, void *arg);
+        int SetProcessThreadAffinity(const char* cpus);
 
         // Session API
         jack_session_command_t* SessionNotify(const char* target, jack_session_event_type_t type, const char* path);
@@ -55,6 +55,9 @@ extern "C"
         value.ui = 21333U;
         jack_driver_descriptor_add_parameter(desc, &filler, "wait", 'w', JackDriverParamUInt, &value, NULL, "Number of usecs to wait between engine processes", NULL);
 
+        value.ui = 0U;
+        jack_driver_descriptor_add_parameter(desc, &filler, "spin", 's', JackDriverParamUInt, &value, NULL, "Number of usecs to busy wait before each cycle", NULL);
+
         return desc;
     }
 
@@ -64,6 +67,7 @@ extern "C"
         unsigned int capture_ports = 2;
         unsigned int playback_ports = 2;
         int wait_time = 0;
+        int spin_time = 0;
         const JSList * node;
         const jack_driver_param_t * param;
         bool monitor = false;
@@ -93,6 +97,10 @@ extern "C"
                     wait_time = param->value.ui;
                     break;
 
+                case 's':
+                    spin_time = param->value.ui;
+                    break;
+
                 case 'm':
                     monitor = param->value.i;
                     break;
@@ -108,7 +116,9 @@ extern "C"
             jack_error("Buffer size set to %d", BUFFER_SIZE_MAX);
         }
 
-        Jack::JackDriverClientInterface* driver = new Jack::JackThreadedDriver(new Jack::JackDummyDriver("system", "dummy_pcm", engine, table));
+        Jack::JackDummyDriver* dummy_driver = new Jack::JackDummyDriver("system", "dummy_pcm", engine, table);
+        dummy_driver->SetSpin(spin_time);
+        Jack::JackDriverClientInterface* driver = new Jack::JackThreadedDriver(dummy_driver);
         if (driver->Open(buffer_size, sample_rate, 1, 1, capture_ports, playback_ports, monitor, "dummy", "dummy", 0, 0) == 0) {
             return driver;
         } else {
@@ -33,6 +33,7 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "JackGlobals.h"
 #include "JackChannel.h"
 #include "JackError.h"
+#include "JackTools.h"
 
 extern const char* JACK_METADATA_HARDWARE;
 extern const char* JACK_METADATA_PRETTY_NAME;
@@ -54,7 +55,12 @@ JackEngine::JackEngine(JackGraphManager* manager,
     fSelfConnectMode = self_connect_mode;
     for (int i = 0; i < CLIENT_NUM; i++) {
         fClientTable[i] = NULL;
+        fCaptureLatency[i] = false;
+        fPlaybackLatency[i] = false;
     }
+    fSortedRefNum.reserve(CLIENT_NUM + 2);
+    fLatencyPending = false;
+    fLatencyIndex = 0;
     fLastSwitchUsecs = 0;
     fSessionPendingReplies = 0;
     fSessionTransaction = NULL;
@@ -72,18 +78,24 @@ int JackEngine::Open()
     if (fChannel.Open(fEngineControl->fServerName) < 0) {
         jack_error("Cannot connect to server");
         return -1;
-    } else {
-        return 0;
     }
+
+    if (fWorkerPool.Open(fEngineControl) < 0) {
+        fChannel.Close();
+        return -1;
+    }
+
+    return 0;
 }
 
 int JackEngine::Close()
 {
     jack_log("JackEngine::Close");
     fChannel.Close();
+    fWorkerPool.Close();
 
     // Close remaining clients (RT is stopped)
-    for (int i = fEngineControl->fDriverNum; i < CLIENT_NUM; i++) {
+    for (int i = fEngineControl->fDriverNum; i < fEngineControl->fClientEnd; i++) {
         if (JackLoadableInternalClient* loadable_client = dynamic_cast<JackLoadableInternalClient*>(fClientTable[i])) {
             jack_log("JackEngine::Close loadable client = %s", loadable_client->GetClientControl()->fName);
             loadable_client->Close();
@@ -112,27 +124,67 @@ void JackEngine::NotifyQuit()
 
 int JackEngine::AllocateRefnum()
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientMax; i++) {
         if (!fClientTable[i]) {
             jack_log("JackEngine::AllocateRefNum ref = %ld", i);
+            if (i >= fEngineControl->fClientEnd) {
+                fEngineControl->fClientEnd = i + 1;
+            }
             return i;
         }
     }
     return -1;
 }
 
+/*!
+\brief Suggest the least used CPU of the client CPU list to a new client.
+
+Spreading clients RT threads over the CPUs lets independent graph branches run in parallel.
+*/
+void JackEngine::SuggestCPU(JackClientControl* control)
+{
+    int cpus[JACK_CPU_LIST_MAX];
+    int count = JackTools::ParseCPUList(fEngineControl->fClientCPUs, cpus, JACK_CPU_LIST_MAX);
+    int best_use = CLIENT_NUM + 1;
+
+    control->fSuggestedCPU = -1;
+
+    for (int cpu = 0; cpu < count; cpu++) {
+        int use = 0;
+        for (int i = 0; i < fEngineControl->fClientEnd; i++) {
+            JackClientInterface* client = fClientTable[i];
+            if (client && client->GetClientControl() != control && client->GetClientControl()->fSuggestedCPU == cpus[cpu]) {
+                use++;
+            }
+        }
+        if (use < best_use) {
+            best_use = use;
+            control->fSuggestedCPU = cpus[cpu];
+        }
+    }
+
+    if (control->fSuggestedCPU >= 0) {
+        jack_log("JackEngine::SuggestCPU name = %s cpu = %d", control->fName, control->fSuggestedCPU);
+    }
+}
+
 void JackEngine::ReleaseRefnum(int refnum)
 {
     fClientTable[refnum] = NULL;
 
+    // Loops over clients stop after the highest refnum still in use
+    while (fEngineControl->fClientEnd > 0 && !fClientTable[fEngineControl->fClientEnd - 1]) {
+        fEngineControl->fClientEnd--;
+    }
+
     if (fEngineControl->fTemporary) {
         int i;
-        for (i = fEngineControl->fDriverNum; i < CLIENT_NUM; i++) {
+        for (i = fEngineControl->fDriverNum; i < fEngineControl->fClientEnd; i++) {
             if (fClientTable[i]) {
                 break;
             }
         }
-        if (i == CLIENT_NUM) {
+        if (i == fEngineControl->fClientEnd) {
             // Last client and temporary case: quit the server
             jack_log("JackEngine::ReleaseRefnum server quit");
             fEngineControl->fTemporary = false;
@@ -151,9 +203,37 @@ void JackEngine::ProcessNext(jack_time_t cur_cycle_begin)
     if (fGraphManager->RunNextGraph())  {   // True if the graph actually switched to a new state
         fChannel.Notify(ALL_CLIENTS, kGraphOrderCallback, 0);
     }
+    fGraphManager->ShiftPipeline();  // Delayed outputs for the pipeline stages
     fSignal.Signal();                       // Signal for threads waiting for next cycle
 }
 
+// Graph state indexes wrap around
+static inline bool IsStateReached(UInt16 cur_index, UInt16 index)
+{
+    return UInt16(cur_index - index) < 0x8000;
+}
+
+/*!
+\brief Wait until the RT thread runs the last written graph state : the states before are not used anymore.
+
+Several changes written before the switch are waited for only once, and there is nothing to wait for when the switch
+already happened.
+*/
+bool JackEngine::WaitGraphChange(long timeout_usec)
+{
+    UInt16 index = fGraphManager->GetNextIndex();
+    jack_time_t end_usec = GetMicroSeconds() + timeout_usec;
+
+    // Each cycle switching to a new state signals
+    while (!IsStateReached(fGraphManager->GetCurrentIndex(), index)) {
+        jack_time_t cur_usec = GetMicroSeconds();
+        if (cur_usec >= end_usec || !fSignal.LockedTimedWait(long(end_usec - cur_usec))) {
+            return IsStateReached(fGraphManager->GetCurrentIndex(), index);
+        }
+    }
+    return true;
+}
+
 void JackEngine::ProcessCurrent(jack_time_t cur_cycle_begin)
 {
     if (cur_cycle_begin < fLastSwitchUsecs + 2 * fEngineControl->fPeriodUsecs) { // Signal XRun only for the first failing cycle
@@ -168,6 +248,8 @@ bool JackEngine::Process(jack_time_t cur_cycle_begin, jack_time_t prev_cycle_end
 
     // Cycle  begin
     fEngineControl->CycleBegin(fClientTable, fGraphManager, cur_cycle_begin, prev_cycle_end);
+    fTimingStats.Update(fClientTable, fGraphManager, fEngineControl->fDriverNum, fEngineControl->fClientEnd, fEngineControl->fClientStats, fEngineControl->fClientWake);
+    fWorkerPool.NotifyEnded(&fChannel);
 
     // Graph
     if (fGraphManager->IsFinishedGraph()) {
@@ -214,7 +296,7 @@ static const char* State2String(jack_client_state_t state)
 
 void JackEngine::CheckXRun(jack_time_t callback_usecs)  // REVOIR les conditions de fin
 {
-    for (int i = fEngineControl->fDriverNum; i < CLIENT_NUM; i++) {
+    for (int i = fEngineControl->fDriverNum; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && client->GetClientControl()->fActive) {
             JackClientTiming* timing = fGraphManager->GetClientTiming(i);
@@ -236,24 +318,51 @@ void JackEngine::CheckXRun(jack_time_t callback_usecs)  // REVOIR les conditions
 
 int JackEngine::ComputeTotalLatencies()
 {
-    std::vector<jack_int_t> sorted;
+    bool capture[CLIENT_NUM];
+    bool playback[CLIENT_NUM];
+
+    // Explicit request : latencies of all clients are recomputed
+    for (int i = 0; i < CLIENT_NUM; i++) {
+        capture[i] = playback[i] = true;
+    }
+    return ComputeLatencies(capture, playback);
+}
+
+/*!
+\brief A connection changed the capture latency downstream of capture_refnum, and the playback latency upstream of playback_refnum.
+*/
+void JackEngine::InvalidateLatency(int capture_refnum, int playback_refnum)
+{
+    fCaptureLatency[capture_refnum] = true;
+    fPlaybackLatency[playback_refnum] = true;
+    fLatencyPending = true;
+    // The change is only effective in the next graph state
+    fLatencyIndex = fGraphManager->GetCurrentIndex();
+}
+
+int JackEngine::ComputeLatencies(bool* capture, bool* playback)
+{
     std::vector<jack_int_t>::iterator it;
     std::vector<jack_int_t>::reverse_iterator rit;
 
-    fGraphManager->TopologicalSort(sorted);
+    fGraphManager->TopologicalSort(fSortedRefNum, capture, playback);
 
-    /* iterate over all clients in graph order, and emit
+    /* iterate over the marked clients in graph order, and emit
      * capture latency callback.
      */
 
-    for (it = sorted.begin(); it != sorted.end(); it++) {
-        NotifyClient(*it, kLatencyCallback, true, "", 0, 0);
+    for (it = fSortedRefNum.begin(); it != fSortedRefNum.end(); it++) {
+        if (capture[*it]) {
+            NotifyClient(*it, kLatencyCallback, true, "", 0, 0);
+        }
     }
 
     /* now issue playback latency callbacks in reverse graph order.
      */
-    for (rit = sorted.rbegin(); rit != sorted.rend(); rit++) {
-        NotifyClient(*rit, kLatencyCallback, true, "", 1, 0);
+    for (rit = fSortedRefNum.rbegin(); rit != fSortedRefNum.rend(); rit++) {
+        if (playback[*rit]) {
+            NotifyClient(*rit, kLatencyCallback, true, "", 1, 0);
+        }
     }
 
     return 0;
@@ -267,7 +376,7 @@ int JackEngine::PropertyChangeNotify(jack_uuid_t subject, const char* key, jack_
 {
     jack_log("JackEngine::PropertyChangeNotify: subject = %x key = %s change = %x", subject, key, change);
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client) {
             char buf[JACK_UUID_STRING_SIZE];
@@ -321,7 +430,7 @@ void JackEngine::NotifyClient(int refnum, int event, int sync, const char* messa
 
 void JackEngine::NotifyClients(int event, int sync, const char* message, int value1, int value2)
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         NotifyClient(i, event, sync, message, value1, value2);
     }
 }
@@ -331,7 +440,7 @@ int JackEngine::NotifyAddClient(JackClientInterface* new_client, const char* new
     jack_log("JackEngine::NotifyAddClient: name = %s", new_name);
 
     // Notify existing clients of the new client and new client of existing clients.
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* old_client = fClientTable[i];
         if (old_client && old_client != new_client) {
             char* old_name = old_client->GetClientControl()->fName;
@@ -352,7 +461,7 @@ int JackEngine::NotifyAddClient(JackClientInterface* new_client, const char* new
 void JackEngine::NotifyRemoveClient(const char* name, int refnum)
 {
     // Notify existing clients (including the one being suppressed) of the removed client
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client) {
             ClientNotify(client, refnum, name, kRemoveClient, false, "", 0, 0);
@@ -378,20 +487,45 @@ void JackEngine::NotifyClientXRun(int refnum)
 
 void JackEngine::NotifyGraphReorder()
 {
-    ComputeTotalLatencies();
+    // Only the part of the graph reached by the connections changes is notified
+    if (fLatencyPending && fLatencyIndex != fGraphManager->GetCurrentIndex()) {
+        if (fEngineControl->fPipelineStages > 1) {
+            // Stages are partitioned again, delayed connections may have moved anywhere
+            for (int i = 0; i < CLIENT_NUM; i++) {
+                fCaptureLatency[i] = fPlaybackLatency[i] = true;
+            }
+        }
+        ComputeLatencies(fCaptureLatency, fPlaybackLatency);
+        for (int i = 0; i < CLIENT_NUM; i++) {
+            fCaptureLatency[i] = fPlaybackLatency[i] = false;
+        }
+        fLatencyPending = false;
+    }
     NotifyClients(kGraphOrderCallback, false, "", 0, 0);
 }
 
 void JackEngine::NotifyBufferSize(jack_nframes_t buffer_size)
 {
+    UpdateSyncSpin();
     NotifyClients(kBufferSizeCallback, true, "", buffer_size, 0);
 }
 
 void JackEngine::NotifySampleRate(jack_nframes_t sample_rate)
 {
+    UpdateSyncSpin();
     NotifyClients(kSampleRateCallback, true, "", sample_rate, 0);
 }
 
+// The spin time bound follows the period
+void JackEngine::UpdateSyncSpin()
+{
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
+        if (fClientTable[i]) {
+            fSynchroTable[i].SetSpin(fEngineControl->SyncSpinUsecs());
+        }
+    }
+}
+
 void JackEngine::NotifyFailure(int code, const char* reason)
 {
     NotifyClients(kShutDownCallback, false, reason, code, 0);
@@ -403,10 +537,12 @@ void JackEngine::NotifyFreewheel(bool onoff)
         // Save RT state
         fEngineControl->fSavedRealTime = fEngineControl->fRealTime;
         fEngineControl->fRealTime = false;
+        fEngineControl->fFreewheel = true;
     } else {
         // Restore RT state
         fEngineControl->fRealTime = fEngineControl->fSavedRealTime;
         fEngineControl->fSavedRealTime = false;
+        fEngineControl->fFreewheel = false;
     }
     NotifyClients((onoff ? kStartFreewheelCallback : kStopFreewheelCallback), true, "", 0, 0);
 }
@@ -448,7 +584,7 @@ int JackEngine::InternalClientHandle(const char* client_name, int* status, int*
     // Clear status
     *status = 0;
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && dynamic_cast<JackLoadableInternalClient*>(client) && (strcmp(client->GetClientControl()->fName, client_name) == 0)) {
             jack_log("InternalClientHandle found client name = %s ref = %ld",  client_name, i);
@@ -551,7 +687,7 @@ bool JackEngine::GenerateUniqueName(char* name)
 
 bool JackEngine::ClientCheckName(const char* name)
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && (strcmp(client->GetClientControl()->fName, name) == 0)) {
             return true;
@@ -572,7 +708,7 @@ void JackEngine::EnsureUUID(jack_uuid_t uuid)
     if (jack_uuid_empty(uuid))
         return;
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && jack_uuid_compare(client->GetClientControl()->fSessionID, uuid) == 0) {
             // FIXME? this code does nothing, but jack1 has it like this too..
@@ -584,7 +720,7 @@ void JackEngine::EnsureUUID(jack_uuid_t uuid)
 
 int JackEngine::GetClientPID(const char* name)
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && (strcmp(client->GetClientControl()->fName, name) == 0)) {
             return client->GetClientControl()->fPID;
@@ -596,7 +732,7 @@ int JackEngine::GetClientPID(const char* name)
 
 int JackEngine::GetClientRefNum(const char* name)
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && (strcmp(client->GetClientControl()->fName, name) == 0)) {
             return client->GetClientControl()->fRefNum;
@@ -639,11 +775,13 @@ int JackEngine::ClientExternalOpen(const char* name, int pid, jack_uuid_t uuid,
         jack_error("Cannot allocate synchro");
         goto error;
     }
+    fSynchroTable[refnum].SetSpin(fEngineControl->SyncSpinUsecs());
 
     if (client->Open(real_name, pid, refnum, uuid, shared_client) < 0) {
         jack_error("Cannot open client");
         goto error;
     }
+    SuggestCPU(client->GetClientControl());
 
     if (!fSignal.LockedTimedWait(DRIVER_OPEN_TIMEOUT * 1000000)) {
         // Failure if RT thread is not running (problem with the driver...)
@@ -689,6 +827,7 @@ int JackEngine::ClientInternalOpen(const char* name, int* ref, JackEngineControl
         jack_error("Cannot allocate synchro");
         goto error;
     }
+    fSynchroTable[refnum].SetSpin(fEngineControl->SyncSpinUsecs());
 
     if (wait && !fSignal.LockedTimedWait(DRIVER_OPEN_TIMEOUT * 1000000)) {
         // Failure if RT thread is not running (problem with the driver...)
@@ -696,6 +835,15 @@ int JackEngine::ClientInternalOpen(const char* name, int* ref, JackEngineControl
         goto error;
     }
 
+    // Drivers (opened with wait = false) run on the driver thread
+    if (wait) {
+        SuggestCPU(client->GetClientControl());
+        // Internal clients are identified by their UUID in the trace ring, like external ones
+        if (jack_uuid_empty(client->GetClientControl()->fSessionID)) {
+            client->GetClientControl()->fSessionID = jack_client_uuid_generate();
+        }
+    }
+
     fClientTable[refnum] = client;
 
     if (NotifyAddClient(client, name, refnum) < 0) {
@@ -795,11 +943,13 @@ int JackEngine::ClientActivate(int refnum, bool is_real_time)
     jack_log("JackEngine::ClientActivate ref = %ld name = %s", refnum, client->GetClientControl()->fName);
 
     if (is_real_time) {
+        fWorkerPool.AddClient(refnum);
         fGraphManager->Activate(refnum);
+        InvalidateLatency(refnum, refnum);
     }
 
     // Wait for graph state change to be effective
-    if (!fSignal.LockedTimedWait(fEngineControl->fTimeOutUsecs * 10)) {
+    if (!WaitGraphChange(fEngineControl->fTimeOutUsecs * 10)) {
         jack_error("JackEngine::ClientActivate wait error ref = %ld name = %s", refnum, client->GetClientControl()->fName);
         return -1;
     } else {
@@ -854,10 +1004,12 @@ int JackEngine::ClientDeactivate(int refnum)
     fLastSwitchUsecs = 0; // Force switch to occur next cycle, even when called with "dead" clients
 
     // Wait for graph state change to be effective
-    if (!fSignal.LockedTimedWait(fEngineControl->fTimeOutUsecs * 10)) {
+    if (!WaitGraphChange(fEngineControl->fTimeOutUsecs * 10)) {
         jack_error("JackEngine::ClientDeactivate wait error ref = %ld name = %s", refnum, client->GetClientControl()->fName);
+        fWorkerPool.RemoveClient(refnum);
         return -1;
     } else {
+        fWorkerPool.RemoveClient(refnum);
         return 0;
     }
 }
@@ -1019,11 +1171,23 @@ int JackEngine::PortConnect(int refnum, jack_port_id_t src, jack_port_id_t dst)
 
     res = fGraphManager->Connect(src, dst);
     if (res == 0) {
+        InvalidateLatency(fGraphManager->GetInputRefNum(dst), fGraphManager->GetOutputRefNum(src));
         NotifyPortConnect(src, dst, true);
     }
     return res;
 }
 
+int JackEngine::SetConnectionGain(int refnum, const char* src, const char* dst, float gain)
+{
+    jack_log("JackEngine::SetConnectionGain ref = %d src = %s dst = %s gain = %f", refnum, src, dst, gain);
+    jack_port_id_t port_src, port_dst;
+
+    if (fGraphManager->GetTwoPorts(src, dst, &port_src, &port_dst) < 0 || fGraphManager->CheckPorts(port_src, port_dst) < 0) {
+        return -1;
+    }
+    return fGraphManager->SetConnectionGain(port_src, port_dst, gain);
+}
+
 int JackEngine::PortDisconnect(int refnum, const char* src, const char* dst)
 {
     jack_log("JackEngine::PortDisconnect ref = %d src = %s dst = %s", refnum, src, dst);
@@ -1072,8 +1236,10 @@ int JackEngine::PortDisconnect(int refnum, jack_port_id_t src, jack_port_id_t ds
     }
 
     res = fGraphManager->Disconnect(src, dst);
-    if (res == 0)
+    if (res == 0) {
+        InvalidateLatency(fGraphManager->GetInputRefNum(dst), fGraphManager->GetOutputRefNum(src));
         NotifyPortConnect(src, dst, false);
+    }
     return res;
 }
 
@@ -1119,7 +1285,7 @@ void JackEngine::SessionNotify(int refnum, const char *target, jack_session_even
         return;
     }
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && jack_uuid_empty(client->GetClientControl()->fSessionID)) {
             client->GetClientControl()->fSessionID = jack_client_uuid_generate();
@@ -1127,7 +1293,7 @@ void JackEngine::SessionNotify(int refnum, const char *target, jack_session_even
     }
     fSessionResult = new JackSessionNotifyResult();
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
         if (client && client->GetClientControl()->fCallback[kSessionCallback]) {
 
@@ -1199,7 +1365,7 @@ int JackEngine::SessionReply(int refnum)
 
 int JackEngine::GetUUIDForClientName(const char *client_name, char *uuid_res)
 {
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
 
         if (client && (strcmp(client_name, client->GetClientControl()->fName) == 0)) {
@@ -1217,7 +1383,7 @@ int JackEngine::GetClientNameForUUID(const char *uuid_buf, char *name_res)
     if (jack_uuid_parse(uuid_buf, &uuid) != 0)
         return -1;
 
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         JackClientInterface* client = fClientTable[i];
 
         if (!client) {
@@ -1256,7 +1422,7 @@ int JackEngine::ReserveClientName(const char *name, const char *uuidstr)
 int JackEngine::ClientHasSessionCallback(const char *name)
 {
     JackClientInterface* client = NULL;
-    for (int i = 0; i < CLIENT_NUM; i++) {
+    for (int i = 0; i < fEngineControl->fClientEnd; i++) {
         client = fClientTable[i];
         if (client && (strcmp(client->GetClientControl()->fName, name) == 0)) {
             break;
@@ -28,6 +28,8 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "JackPlatformPlug.h"
 #include "JackRequest.h"
 #include "JackChannel.h"
+#include "JackTimingStats.h"
+#include "JackWorkerPool.h"
 #include <map>
 
 namespace Jack
@@ -56,6 +58,13 @@ class SERVER_EXPORT JackEngine : public JackLockAble
         JackProcessSync fSignal;
         jack_time_t fLastSwitchUsecs;
         JackMetadata fMetadata;
+        JackTimingStats fTimingStats;
+        JackWorkerPool fWorkerPool;                    /*! Runs internal clients cycles */
+        std::vector<jack_int_t> fSortedRefNum;         /*! Graph order, storage kept between graph changes */
+        bool fCaptureLatency[CLIENT_NUM];              /*! Clients whose capture latency has to be recomputed */
+        bool fPlaybackLatency[CLIENT_NUM];             /*! Clients whose playback latency has to be recomputed */
+        bool fLatencyPending;
+        UInt16 fLatencyIndex;                          /*! Graph state index when latencies were last invalidated */
 
         int fSessionPendingReplies;
         detail::JackChannelTransactionInterface* fSessionTransaction;
@@ -63,11 +72,15 @@ class SERVER_EXPORT JackEngine : public JackLockAble
         std::map<int,std::string> fReservationMap;
 
         int ClientCloseAux(int refnum, bool wait);
+        bool WaitGraphChange(long timeout_usec);
         void CheckXRun(jack_time_t callback_usecs);
 
         int NotifyAddClient(JackClientInterface* new_client, const char* new_name, int refnum);
         void NotifyRemoveClient(const char* name, int refnum);
 
+        void InvalidateLatency(int capture_refnum, int playback_refnum);
+        int ComputeLatencies(bool* capture, bool* playback);
+
         void ProcessNext(jack_time_t callback_usecs);
         void ProcessCurrent(jack_time_t callback_usecs);
 
@@ -77,6 +90,9 @@ class SERVER_EXPORT JackEngine : public JackLockAble
         int AllocateRefnum();
         void ReleaseRefnum(int refnum);
 
+        void SuggestCPU(JackClientControl* control);
+        void UpdateSyncSpin();
+
         int ClientNotify(JackClientInterface* client, int refnum, const char* name, int notify, int sync, const char* message, int value1, int value2);
 
         void NotifyClient(int refnum, int event, int sync, const char*  message, int value1, int value2);
@@ -136,6 +152,8 @@ class SERVER_EXPORT JackEngine : public JackLockAble
         int PortConnect(int refnum, jack_port_id_t src, jack_port_id_t dst);
         int PortDisconnect(int refnum, jack_port_id_t src, jack_port_id_t dst);
 
+        int SetConnectionGain(int refnum, const char* src, const char* dst, float gain);
+
         int PortRename(int refnum, jack_port_id_t port, const char* name);
 
         int PortSetDefaultMetadata(jack_port_id_t port, const char* pretty_name);
@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackClientControl.h"
 #include <algorithm>
 #include <math.h>
+#include <string.h>
 
 namespace Jack
 {
@@ -42,9 +43,14 @@ void JackEngineControl::CalcCPULoad(JackClientInterface** table,
     fCurCycleTime = cur_cycle_begin;
     jack_time_t last_cycle_end = prev_cycle_end;
 
+    // Cycles run back to back in freewheel mode, the load is meaningless
+    if (fFreewheel) {
+        return;
+    }
+
     // In Asynchronous mode, last cycle end is the max of client end dates
     if (!fSyncMode) {
-        for (int i = fDriverNum; i < CLIENT_NUM; i++) {
+        for (int i = fDriverNum; i < fClientEnd; i++) {
             JackClientInterface* client = table[i];
             JackClientTiming* timing = manager->GetClientTiming(i);
             if (client && client->GetClientControl()->fActive && timing->fStatus == Finished) {
@@ -106,4 +112,103 @@ void JackEngineControl::NotifyXRun(jack_time_t callback_usecs, float delayed_use
     }
 }
 
+void JackEngineControl::CycleIncTime(jack_time_t callback_usecs)
+{
+    // Histograms are only written by the RT thread, readers request the reset
+    SInt32 reset_request = fWakeResetRequest;
+    if (reset_request != fWakeResetDone) {
+        fDriverWake.Clear();
+        fDriverWakeEarly.Clear();
+        for (int i = 0; i < CLIENT_NUM; i++) {
+            fClientWake[i].Clear();
+        }
+        fWakeResetDone = reset_request;
+    }
+
+    // Driver wake-up delay against the date predicted by the frame timer at the previous cycle, not in freewheel mode.
+    // Early wake-ups (e.g. a period shortened by the driver) are kept apart from the late ones.
+    JackTimer timer;
+    jack_nframes_t frames;
+    jack_time_t current_usecs, next_usecs;
+    float period_usecs;
+    if (!fFreewheel) {
+        fFrameTimer.ReadFrameTime(&timer);
+        if (timer.GetCycleTimes(&frames, &current_usecs, &next_usecs, &period_usecs) == 0) {
+            if (callback_usecs >= next_usecs) {
+                fDriverWake.Add(callback_usecs - next_usecs);
+            } else {
+                fDriverWakeEarly.Add(next_usecs - callback_usecs);
+            }
+        }
+    }
+
+    // Timer
+    fFrameTimer.IncFrameTime(fBufferSize, callback_usecs, fPeriodUsecs);
+}
+
+int JackEngineControl::GetClientRefNum(const char* name)
+{
+    JackClientTimingStats client_stats;
+
+    for (int i = fDriverNum; i < fClientEnd; i++) {
+        if (fClientStats[i].Read(&client_stats) && strcmp(client_stats.fName, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool JackEngineControl::GetClientTimingStats(const char* name, jack_client_timing_stats_t* stats)
+{
+    JackClientTimingStats client_stats;
+    int refnum = GetClientRefNum(name);
+
+    if (refnum >= 0 && fClientStats[refnum].Read(&client_stats) && strcmp(client_stats.fName, name) == 0) {
+        stats->wake_latency_mean = client_stats.fWakeLatencyMean;
+        stats->wake_latency_max = client_stats.fWakeLatencyMax;
+        stats->wake_latency_p99 = client_stats.fWakeLatencyP99;
+        stats->duration_mean = client_stats.fDurationMean;
+        stats->duration_max = client_stats.fDurationMax;
+        stats->duration_p99 = client_stats.fDurationP99;
+        stats->cycles = client_stats.fCycles;
+        stats->deadline_misses = client_stats.fDeadlineMisses;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+static void CopyWakeHistogram(const JackWakeHistogram& src, jack_wake_histogram_t* dst)
+{
+    static_assert(WAKE_HISTOGRAM_BUCKETS == JACK_WAKE_HISTOGRAM_BUCKETS, "wake histogram sizes must match");
+    for (int i = 0; i < WAKE_HISTOGRAM_BUCKETS; i++) {
+        dst->buckets[i] = src.fBuckets[i];
+    }
+    dst->count = src.fCount;
+    dst->max_usecs = src.fMaxUsecs;
+}
+
+bool JackEngineControl::GetDriverWakeHistogram(jack_wake_histogram_t* histogram)
+{
+    CopyWakeHistogram(fDriverWake, histogram);
+    return true;
+}
+
+bool JackEngineControl::GetDriverEarlyWakeHistogram(jack_wake_histogram_t* histogram)
+{
+    CopyWakeHistogram(fDriverWakeEarly, histogram);
+    return true;
+}
+
+bool JackEngineControl::GetClientWakeHistogram(const char* name, jack_wake_histogram_t* histogram)
+{
+    int refnum = GetClientRefNum(name);
+    if (refnum >= 0) {
+        CopyWakeHistogram(fClientWake[refnum], histogram);
+        return true;
+    } else {
+        return false;
+    }
+}
+
 } // end of namespace
@@ -25,12 +25,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackFrameTimer.h"
 #include "JackTransportEngine.h"
 #include "JackConstants.h"
+#include "JackAtomic.h"
 #include "types.h"
+#include "statistics.h"
 #include <stdio.h>
 
-#ifdef JACK_MONITOR
-#include "JackEngineProfiling.h"
-#endif
+#include "JackEngineTrace.h"
+#include "JackTimingStats.h"
 
 namespace Jack
 {
@@ -67,7 +68,20 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
     alignas(UInt32) alignas(JackTransportEngine) JackTransportEngine fTransport;
     jack_timer_type_t fClockSource;
     int fDriverNum;
+    int fClientMax;       // Max number of clients (drivers included), at most CLIENT_NUM : shm structures stay sized from CLIENT_NUM
+    int fClientEnd;       // One past the highest refnum in use : loops over clients stop there
     bool fVerbose;
+    int fSyncSpinUsecs;   // Max time clients poll their synchro before sleeping, 0 disables spinning
+    char fDriverCPUs[JACK_CPU_LIST_SIZE];   // CPUs the driver thread is pinned to, empty for no pinning
+    char fClientCPUs[JACK_CPU_LIST_SIZE];   // CPUs suggested to clients RT threads, empty for no pinning
+    int fDeadlineRuntime; // Percent of the period reserved to each RT thread with SCHED_DEADLINE, 0 to use fixed priorities
+    jack_nframes_t fFreewheelBufferSize;  // Buffer size used in freewheel mode, 0 to keep the current one
+    bool fFreewheel;
+    int fPipelineStages;  // Number of stages the graph is partitioned in, 1 for non pipelined execution
+    int fWakeFanout;      // Min number of clients woken by the same client to wake them as a tree, 0 to disable
+    int fWorkerCount;     // Number of server threads running internal clients cycles, 0 to use their own thread only
+    bool fServerMix;      // Client inputs connected to several outputs are mixed when the client is made ready, not by the client
+    bool fTraceAnalysis;  // Critical path and slack of the traced clients are computed at each cycle
 
     // CPU Load
     jack_time_t fPrevCycleTime;
@@ -88,9 +102,18 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
     // Timer
     alignas(UInt32) alignas(JackFrameTimer) JackFrameTimer fFrameTimer;
 
-#ifdef JACK_MONITOR
-    JackEngineProfiling fProfiler;
-#endif
+    // Trace
+    alignas(UInt32) alignas(JackEngineTrace) JackEngineTrace fTrace;
+
+    // Clients timing statistics, indexed by refnum
+    alignas(UInt32) alignas(JackClientTimingStats) JackClientTimingStats fClientStats[CLIENT_NUM];
+
+    // Wake-up delay histograms : driver late and early against the frame timer prediction, clients against their signal date
+    alignas(UInt32) alignas(JackWakeHistogram) JackWakeHistogram fDriverWake;
+    alignas(UInt32) alignas(JackWakeHistogram) JackWakeHistogram fDriverWakeEarly;
+    alignas(UInt32) alignas(JackWakeHistogram) JackWakeHistogram fClientWake[CLIENT_NUM];
+    alignas(SInt32) volatile SInt32 fWakeResetRequest;  // Incremented by readers, histograms are cleared by the RT thread
+    SInt32 fWakeResetDone;
 
     JackEngineControl(bool sync, bool temporary, long timeout, bool rt, long priority, bool verbose, jack_timer_type_t clock, const char* server_name)
       {
@@ -98,6 +121,14 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
                       "fTransport must be aligned within JackEngineControl");
         static_assert(offsetof(JackEngineControl, fFrameTimer) % sizeof(UInt32) == 0,
                       "fFrameTimer must be aligned within JackEngineControl");
+        static_assert(offsetof(JackEngineControl, fTrace) % sizeof(UInt32) == 0,
+                      "fTrace must be aligned within JackEngineControl");
+        static_assert(offsetof(JackEngineControl, fClientStats) % sizeof(UInt32) == 0,
+                      "fClientStats must be aligned within JackEngineControl");
+        static_assert(offsetof(JackEngineControl, fDriverWake) % sizeof(UInt32) == 0,
+                      "fDriverWake must be aligned within JackEngineControl");
+        static_assert(offsetof(JackEngineControl, fClientWake) % sizeof(UInt32) == 0,
+                      "fClientWake must be aligned within JackEngineControl");
         fBufferSize = 512;
         fSampleRate = 48000;
         fPeriodUsecs = jack_time_t(1000000.f / fSampleRate * fBufferSize);
@@ -131,11 +162,40 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
         fXrunDelayedUsecs = 0.f;
         fClockSource = clock;
         fDriverNum = 0;
+        fClientMax = CLIENT_NUM;
+        fClientEnd = 0;
+        fSyncSpinUsecs = 0;
+        fDriverCPUs[0] = 0;
+        fClientCPUs[0] = 0;
+        fDeadlineRuntime = 0;
+        fFreewheelBufferSize = 0;
+        fFreewheel = false;
+        fPipelineStages = 1;
+        fWakeFanout = 0;
+        fWorkerCount = 0;
+        fServerMix = false;
+        fTraceAnalysis = false;
+        fWakeResetRequest = 0;
+        fWakeResetDone = 0;
     }
 
     ~JackEngineControl()
     {}
 
+    // SCHED_DEADLINE runtime in nanoseconds, never below the computation hint set by the driver
+    UInt64 DeadlineRuntime()
+    {
+        UInt64 runtime = fPeriod * fDeadlineRuntime / 100;
+        return (runtime > fComputation) ? runtime : fComputation;
+    }
+
+    // Spin time of client synchros, bounded by a quarter of the period whatever the configured one
+    int SyncSpinUsecs()
+    {
+        int max_spin = int(fPeriodUsecs / 4);
+        return (fSyncSpinUsecs < max_spin) ? fSyncSpinUsecs : max_spin;
+    }
+
     void UpdateTimeOut()
     {
         fPeriodUsecs = jack_time_t(1000000.f / fSampleRate * fBufferSize); // In microsec
@@ -145,19 +205,13 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
     }
 
     // Cycle
-    void CycleIncTime(jack_time_t callback_usecs)
-    {
-        // Timer
-        fFrameTimer.IncFrameTime(fBufferSize, callback_usecs, fPeriodUsecs);
-    }
+    void CycleIncTime(jack_time_t callback_usecs);
 
     void CycleBegin(JackClientInterface** table, JackGraphManager* manager, jack_time_t cur_cycle_begin, jack_time_t prev_cycle_end)
     {
         fTransport.CycleBegin(fSampleRate, cur_cycle_begin);
         CalcCPULoad(table, manager, cur_cycle_begin, prev_cycle_end);
-#ifdef JACK_MONITOR
-        fProfiler.Profile(table, manager, fPeriodUsecs, cur_cycle_begin, prev_cycle_end);
-#endif
+        fTrace.Trace(table, manager, fDriverNum, fClientEnd, fPeriodUsecs, fPrevCycleTime, prev_cycle_end, fTraceAnalysis);
     }
 
     void CycleEnd(JackClientInterface** table)
@@ -181,6 +235,17 @@ struct SERVER_EXPORT JackEngineControl : public JackShmMem
         fFrameTimer.ReadFrameTime(timer);
     }
 
+    // Clients timing statistics
+    int GetClientRefNum(const char* name);
+    bool GetClientTimingStats(const char* name, jack_client_timing_stats_t* stats);
+    bool GetDriverWakeHistogram(jack_wake_histogram_t* histogram);
+    bool GetDriverEarlyWakeHistogram(jack_wake_histogram_t* histogram);
+    bool GetClientWakeHistogram(const char* name, jack_wake_histogram_t* histogram);
+    void ResetWakeHistograms()
+    {
+        INC_ATOMIC(&fWakeResetRequest);
+    }
+
     // XRun
     void NotifyXRun(jack_time_t callback_usecs, float delayed_usecs);
     void ResetXRun()
@@ -0,0 +1,251 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#include "JackEngineTrace.h"
+#include "JackGraphManager.h"
+#include "JackClientControl.h"
+#include "JackClientInterface.h"
+#include "JackAtomic.h"
+#include <string.h>
+#include <algorithm>
+
+namespace Jack
+{
+
+JackEngineTrace::JackEngineTrace():fWrite(0),fCycle(0)
+{
+    static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of two");
+    // Force memory page in
+    memset(fEvents, 0, sizeof(fEvents));
+}
+
+void JackEngineTrace::Write(const JackTraceEvent& event)
+{
+    UInt32 write = fWrite;
+    fEvents[write & (TRACE_EVENTS - 1)] = event;
+    JACK_REL_FENCE();
+    fWrite = write + 1;
+}
+
+/*!
+\brief Critical path and slack of the clients of a cycle.
+
+The trigger of a client is its predecessor that finished last before it woke up, the critical path goes back from
+the last client to finish through the triggers. The slack of a client is the latest date it could finish without
+delaying any successor, hence the cycle end, minus its actual end date.
+*/
+void JackEngineTrace::Analyze(JackConnectionManager* connections, JackTraceEvent* events, int count)
+{
+    int trigger[CLIENT_NUM];
+    int order[CLIENT_NUM];
+    jack_time_t ready[CLIENT_NUM];
+    jack_time_t latest[CLIENT_NUM];
+    jack_time_t cycle_end = 0;
+    int last = -1;
+
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+        trigger[i] = -1;
+        ready[i] = events[i].fSignaledAt;
+        if (events[i].fStatus != Finished) {
+            continue;
+        }
+        if (events[i].fFinishedAt > cycle_end) {
+            cycle_end = events[i].fFinishedAt;
+            last = i;
+        }
+        // fSignaledAt is not used : the driver may write it after a predecessor on a loaded machine
+        for (int j = 0; j < count; j++) {
+            if (j != i
+                && events[j].fStatus == Finished
+                && events[j].fFinishedAt <= events[i].fAwakeAt
+                && (trigger[i] < 0 || events[j].fFinishedAt > events[trigger[i]].fFinishedAt)
+                && connections->IsDirectConnection(events[j].fRefNum, events[i].fRefNum)
+                && !connections->IsDelayedConnection(events[j].fRefNum, events[i].fRefNum)) {
+                trigger[i] = j;
+            }
+        }
+        if (trigger[i] >= 0) {
+            events[i].fTriggeredBy = events[trigger[i]].fClient;
+            ready[i] = events[trigger[i]].fFinishedAt;
+        }
+    }
+
+    // Successors finish after their predecessors : compute the latest dates from the end
+    std::sort(order, order + count, [events](int a, int b) { return events[a].fFinishedAt > events[b].fFinishedAt; });
+    for (int i = 0; i < count; i++) {
+        latest[i] = cycle_end;
+    }
+    for (int n = 0; n < count; n++) {
+        int i = order[n];
+        if (events[i].fStatus != Finished) {
+            continue;
+        }
+        for (int k = 0; k < count; k++) {
+            if (k != i && events[k].fStatus == Finished
+                && connections->IsDirectConnection(events[i].fRefNum, events[k].fRefNum)
+                && !connections->IsDelayedConnection(events[i].fRefNum, events[k].fRefNum)) {
+                jack_time_t latest_start = latest[k] - (events[k].fFinishedAt - std::min(ready[k], events[k].fFinishedAt));
+                if (latest_start < latest[i]) {
+                    latest[i] = latest_start;
+                }
+            }
+        }
+        events[i].fSlack = (latest[i] > events[i].fFinishedAt) ? UInt32(latest[i] - events[i].fFinishedAt) : 0;
+    }
+
+    // Walk back from the last client, the path length is bounded in case of feedback loops
+    int length = 0;
+    for (int i = last; i >= 0 && length < count; i = trigger[i]) {
+        length++;
+    }
+    for (int i = last, position = length; i >= 0 && position > 0; i = trigger[i]) {
+        events[i].fCritical = position--;
+    }
+}
+
+void JackEngineTrace::Trace(JackClientInterface** table,
+                            JackGraphManager* manager,
+                            int driver_num,
+                            int client_end,
+                            jack_time_t period_usecs,
+                            jack_time_t prev_cycle_begin,
+                            jack_time_t prev_cycle_end,
+                            bool analyze)
+{
+    // First cycle : nothing to trace yet
+    if (prev_cycle_begin == 0) {
+        return;
+    }
+
+    JackTraceEvent event;
+
+    event.fCycle = fCycle++;
+    event.fRefNum = TRACE_CYCLE;
+    event.fClient = 0;
+    event.fSignaledAt = prev_cycle_begin;
+    event.fAwakeAt = prev_cycle_begin;
+    event.fFinishedAt = prev_cycle_end;
+    event.fStatus = Finished;
+    event.fPeriodUsecs = UInt32(period_usecs);
+    event.fTriggeredBy = 0;
+    event.fSlack = 0;
+    event.fCritical = 0;
+    Write(event);
+
+    if (analyze) {
+        TraceAnalyzed(table, manager, driver_num, client_end, event);
+    } else {
+        for (int i = driver_num; i < client_end; i++) {
+            if (ReadClient(table, manager, i, &event)) {
+                Write(event);
+            }
+        }
+    }
+}
+
+/*!
+\brief Timing of a client during the previous cycle, returns false if it was not triggered.
+*/
+bool JackEngineTrace::ReadClient(JackClientInterface** table, JackGraphManager* manager, int refnum, JackTraceEvent* event)
+{
+    JackClientInterface* client = table[refnum];
+    JackClientTiming* timing = manager->GetClientTiming(refnum);
+    if (client && client->GetClientControl()->fActive && timing->fStatus != NotTriggered) {
+        event->fRefNum = refnum;
+        event->fClient = client->GetClientControl()->fSessionID;
+        event->fSignaledAt = timing->fSignaledAt;
+        event->fAwakeAt = timing->fAwakeAt;
+        event->fFinishedAt = timing->fFinishedAt;
+        event->fStatus = timing->fStatus;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void JackEngineTrace::TraceAnalyzed(JackClientInterface** table,
+                                    JackGraphManager* manager,
+                                    int driver_num,
+                                    int client_end,
+                                    const JackTraceEvent& cycle)
+{
+    JackTraceEvent events[CLIENT_NUM];
+    int count = 0;
+
+    // Timing is copied first, a late client may still be running
+    for (int i = driver_num; i < client_end; i++) {
+        events[count] = cycle;
+        if (ReadClient(table, manager, i, &events[count])) {
+            count++;
+        }
+    }
+
+    // The graph state used during the previous cycle is still the current one
+    Analyze(manager->ReadCurrentState(), events, count);
+
+    for (int i = 0; i < count; i++) {
+        Write(events[i]);
+    }
+}
+
+/*!
+\brief Copy at most count events from position, returns the number of copied events.
+
+Position is updated, lost is set to the number of events overwritten before they could be read.
+*/
+int JackEngineTrace::Read(UInt32* position, JackTraceEvent* events, int count, UInt32* lost)
+{
+    UInt32 write = fWrite;
+    UInt32 pos = *position;
+    UInt32 skipped = 0;
+
+    JACK_ACQ_FENCE();
+
+    if (write - pos > TRACE_EVENTS) {
+        skipped = write - pos - TRACE_EVENTS;
+        pos = write - TRACE_EVENTS;
+    }
+
+    int available = int(write - pos);
+    int copied = (count < available) ? count : available;
+    for (int i = 0; i < copied; i++) {
+        events[i] = fEvents[(pos + i) & (TRACE_EVENTS - 1)];
+    }
+
+    // Slots the writer may have reused while they were copied
+    JACK_ACQ_FENCE();
+    write = fWrite;
+    int overwritten = 0;
+    if (write - pos >= TRACE_EVENTS) {
+        overwritten = int(write - pos - TRACE_EVENTS + 1);
+        if (overwritten > copied) {
+            overwritten = copied;
+        }
+        memmove(events, events + overwritten, (copied - overwritten) * sizeof(JackTraceEvent));
+    }
+
+    *position = pos + copied;
+    if (lost) {
+        *lost = skipped + overwritten;
+    }
+    return copied - overwritten;
+}
+
+} // end of namespace
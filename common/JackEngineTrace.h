@@ -0,0 +1,116 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#ifndef __JackEngineTrace__
+#define __JackEngineTrace__
+
+#include "types.h"
+#include "JackTypes.h"
+#include "JackConstants.h"
+
+namespace Jack
+{
+
+/* TRACE_EVENTS must be a power of two */
+#define TRACE_EVENTS 8192
+#define TRACE_CYCLE -1   /* fRefNum of driver cycle events */
+
+/*!
+\brief Timing of a client, or of the driver cycle, during a given cycle.
+
+For driver cycle events, fSignaledAt and fAwakeAt are the cycle begin date and fFinishedAt the cycle end date.
+For client events, fTriggeredBy is the predecessor that finished last before the client woke up (0 for the driver), fSlack the
+time the client could have finished later without delaying the end of the clients cycle, and fCritical the
+position of the client on the critical path starting from 1, or 0 when not on it.
+*/
+
+PRE_PACKED_STRUCTURE
+struct JackTraceEvent
+{
+    UInt32 fCycle;
+    SInt32 fRefNum;
+    jack_uuid_t fClient;
+    jack_time_t fSignaledAt;
+    jack_time_t fAwakeAt;
+    jack_time_t fFinishedAt;
+    UInt32 fStatus;
+    UInt32 fPeriodUsecs;
+    jack_uuid_t fTriggeredBy;
+    UInt32 fSlack;
+    UInt32 fCritical;
+
+} POST_PACKED_STRUCTURE;
+
+class JackClientInterface;
+class JackGraphManager;
+class JackConnectionManager;
+
+/*!
+\brief Ring of the last cycles timing, in shared memory.
+
+Written lock-free by the server RT thread at each cycle begin for the previous cycle, old events are overwritten.
+The critical path analysis is only done with the "trace-analysis" server parameter : it costs O(n^2) connection
+lookups and a sort per cycle, otherwise the events are written as read and their analysis fields are 0.
+Readers in any process keep their own position and detect the events overwritten while copying them.
+*/
+
+PRE_PACKED_STRUCTURE
+struct SERVER_EXPORT JackEngineTrace
+{
+
+    private:
+
+        JackTraceEvent fEvents[TRACE_EVENTS];
+        alignas(UInt32) volatile UInt32 fWrite;
+        UInt32 fCycle;
+
+        void Write(const JackTraceEvent& event);
+        bool ReadClient(JackClientInterface** table, JackGraphManager* manager, int refnum, JackTraceEvent* event);
+        void Analyze(JackConnectionManager* connections, JackTraceEvent* events, int count);
+        void TraceAnalyzed(JackClientInterface** table,
+                           JackGraphManager* manager,
+                           int driver_num,
+                           int client_end,
+                           const JackTraceEvent& cycle);
+
+    public:
+
+        JackEngineTrace();
+
+        void Trace(JackClientInterface** table,
+                   JackGraphManager* manager,
+                   int driver_num,
+                   int client_end,
+                   jack_time_t period_usecs,
+                   jack_time_t prev_cycle_begin,
+                   jack_time_t prev_cycle_end,
+                   bool analyze);
+
+        UInt32 GetPosition()
+        {
+            return fWrite;
+        }
+
+        int Read(UInt32* position, JackTraceEvent* events, int count, UInt32* lost);
+
+} POST_PACKED_STRUCTURE;
+
+} // end of namespace
+
+#endif
@@ -35,6 +35,8 @@ static bool change_thread_log_function(jack_log_function_t log_function)
 
 SERVER_EXPORT int set_threaded_log_function()
 {
+    // Give the thread its own lock-free ring, otherwise it shares the spill ring
+    JackMessageBufferAddThread();
     return change_thread_log_function(JackMessageBufferAdd);
 }
 
@@ -63,6 +65,14 @@ static void jack_format_and_log(int level, const char *prefix, const char *fmt,
     size_t len;
     jack_log_function_t log_function;
 
+    log_function = (jack_log_function_t)jack_tls_get(JackGlobals::fKeyLogFunction);
+
+    /* RT threads record the raw arguments, formatting is done by the message buffer thread */
+    if (log_function == JackMessageBufferAdd) {
+        JackMessageBufferAddFormat(level, prefix, fmt, ap);
+        return;
+    }
+
     if (prefix != NULL) {
         len = strlen(prefix);
         assert(len < 256);
@@ -73,8 +83,6 @@ static void jack_format_and_log(int level, const char *prefix, const char *fmt,
 
     vsnprintf(buffer + len, sizeof(buffer) - len, fmt, ap);
 
-    log_function = (jack_log_function_t)jack_tls_get(JackGlobals::fKeyLogFunction);
-
     /* if log function is not overridden for thread, use default one */
     if (log_function == NULL)
     {
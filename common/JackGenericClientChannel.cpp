@@ -166,6 +166,13 @@ void JackGenericClientChannel::PortDisconnect(int refnum, const char* src, const
     ServerSyncCall(&req, &res, result);
 }
 
+void JackGenericClientChannel::SetConnectionGain(int refnum, const char* src, const char* dst, float gain, int* result)
+{
+    JackSetConnectionGainRequest req(refnum, src, dst, gain);
+    JackResult res;
+    ServerSyncCall(&req, &res, result);
+}
+
 void JackGenericClientChannel::PortConnect(int refnum, jack_port_id_t src, jack_port_id_t dst, int* result)
 {
     JackPortConnectRequest req(refnum, src, dst);
@@ -72,6 +72,7 @@ class JackGenericClientChannel : public detail::JackClientChannelInterface
         void PortDisconnect(int refnum, jack_port_id_t src, jack_port_id_t dst, int* result);
 
         void PortRename(int refnum, jack_port_id_t port, const char* name, int* result);
+        void SetConnectionGain(int refnum, const char* src, const char* dst, float gain, int* result);
 
         void SetBufferSize(jack_nframes_t buffer_size, int* result);
         void SetFreewheel(int onoff, int* result);
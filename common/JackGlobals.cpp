@@ -23,6 +23,7 @@ namespace Jack
 {
 
 bool JackGlobals::fVerbose = 0;
+bool (*JackGlobals::fDispatchRefNum)(int refnum) = NULL;
 
 jack_tls_key JackGlobals::fRealTimeThread;
 static bool gKeyRealtimeThreadInitialized = jack_tls_allocate_key(&JackGlobals::fRealTimeThread);
@@ -33,6 +34,9 @@ static bool gKeyNotificationThreadInitialized = jack_tls_allocate_key(&JackGloba
 jack_tls_key JackGlobals::fKeyLogFunction;
 static bool fKeyLogFunctionInitialized = jack_tls_allocate_key(&JackGlobals::fKeyLogFunction);
 
+jack_tls_key JackGlobals::fKeyLogRing;
+static bool fKeyLogRingInitialized = jack_tls_allocate_key(&JackGlobals::fKeyLogRing);
+
 JackMutex* JackGlobals::fOpenMutex = new JackMutex();
 JackMutex* JackGlobals::fSynchroMutex = new JackMutex();
 volatile bool JackGlobals::fServerRunning = false;
@@ -40,11 +40,13 @@ struct JackGlobals {
     static jack_tls_key fRealTimeThread;
     static jack_tls_key fNotificationThread;
     static jack_tls_key fKeyLogFunction;
+    static jack_tls_key fKeyLogRing;
     static JackMutex* fOpenMutex;
     static JackMutex* fSynchroMutex;
     static volatile bool fServerRunning;
     static JackClient* fClientTable[CLIENT_NUM];
     static bool fVerbose;
+    static bool (*fDispatchRefNum)(int refnum);     // Server side : run an internal client on the worker pool, NULL if none
 #ifndef WIN32
     static jack_thread_creator_t fJackThreadCreator;
 #endif
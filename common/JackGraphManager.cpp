@@ -21,6 +21,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackGraphManager.h"
 #include "JackConstants.h"
 #include "JackError.h"
+#include "JackEngineControl.h"
+#include "JackGlobals.h"
+#include "JackPortType.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <algorithm>
@@ -49,11 +52,13 @@ void JackGraphManager::AssertPort(jack_port_id_t port_index)
     }
 }
 
-JackGraphManager* JackGraphManager::Allocate(int port_max)
+// Delayed buffers for pipelined execution are only allocated when asked
+JackGraphManager* JackGraphManager::Allocate(int port_max, int delay_buffer_num)
 {
     // Using "Placement" new
-    void* shared_ptr = JackShmMem::operator new(sizeof(JackGraphManager) + port_max * sizeof(JackPort));
-    return new(shared_ptr) JackGraphManager(port_max);
+    void* shared_ptr = JackShmMem::operator new(sizeof(JackGraphManager) + port_max * sizeof(JackPort)
+                                                + delay_buffer_num * (BUFFER_SIZE_MAX + 8) * sizeof(jack_default_audio_sample_t));
+    return new(shared_ptr) JackGraphManager(port_max, delay_buffer_num);
 }
 
 void JackGraphManager::Destroy(JackGraphManager* manager)
@@ -63,15 +68,26 @@ void JackGraphManager::Destroy(JackGraphManager* manager)
     JackShmMem::operator delete(manager);
 }
 
-JackGraphManager::JackGraphManager(int port_max)
+JackGraphManager::JackGraphManager(int port_max, int delay_buffer_num)
 {
+    static_assert(offsetof(JackGraphManager, fClientTiming) % JACK_CACHE_LINE_SIZE == 0,
+                  "fClientTiming must be cache line aligned within JackGraphManager");
+    // The shared memory segment is page aligned : the activation counters of both states really are on their own cache line
+    static_assert(alignof(JackAtomicState<JackConnectionManager>) % JACK_CACHE_LINE_SIZE == 0,
+                  "the connection states must be cache line aligned within JackGraphManager");
+    assert(uintptr_t(&fState[0]) % JACK_CACHE_LINE_SIZE == 0 && uintptr_t(&fState[1]) % JACK_CACHE_LINE_SIZE == 0);
     assert(port_max <= PORT_NUM_MAX);
 
     for (int i = 0; i < port_max; i++) {
         fPortArray[i].Release();
     }
+    for (int i = 0; i < PORT_NUM_MAX; i++) {
+        fMixCycle[i] = 0;
+        fMixIndex[i] = 0;
+    }
 
     fPortMax = port_max;
+    fDelayBufferNum = delay_buffer_num;
 }
 
 JackPort* JackGraphManager::GetPort(jack_port_id_t port_index)
@@ -85,6 +101,29 @@ jack_default_audio_sample_t* JackGraphManager::GetBuffer(jack_port_id_t port_ind
     return fPortArray[port_index].GetBuffer();
 }
 
+jack_default_audio_sample_t* JackGraphManager::GetDelayBuffer(int slot)
+{
+    assert(slot < fDelayBufferNum);
+    jack_default_audio_sample_t* buffer = (jack_default_audio_sample_t*)&fPortArray[fPortMax] + slot * (BUFFER_SIZE_MAX + 8);
+    // Same alignment as port buffers
+    return (jack_default_audio_sample_t*)((uintptr_t)buffer & ~31L) + 8;
+}
+
+bool JackGraphManager::IsDelayedConnection(JackConnectionManager* manager, jack_port_id_t port_src, jack_port_id_t port_dst)
+{
+    return (manager->GetDelaySlot(port_src) != EMPTY
+            && manager->IsDelayedConnection(GetPort(port_src)->GetRefNum(), GetPort(port_dst)->GetRefNum()));
+}
+
+// Connections to a later stage, and feedback connections to an earlier one, read the previous cycle output
+bool JackGraphManager::IsDelayBufferConnection(JackConnectionManager* manager, jack_port_id_t port_src, jack_port_id_t port_dst)
+{
+    int ref1 = GetPort(port_src)->GetRefNum();
+    int ref2 = GetPort(port_dst)->GetRefNum();
+    return (manager->GetDelaySlot(port_src) != EMPTY
+            && (manager->IsDelayedConnection(ref1, ref2) || manager->IsStageFeedbackConnection(ref1, ref2)));
+}
+
 // Server
 void JackGraphManager::InitRefNum(int refnum)
 {
@@ -116,18 +155,47 @@ bool JackGraphManager::IsFinishedGraph()
     return (manager->GetActivation(FREEWHEEL_DRIVER_REFNUM) == 0);
 }
 
+/*
+    Pipelined mode: the graph of the previous cycle is finished, keep the output of ports connected
+    to another stage for the clients of that stage that will run in the current cycle.
+*/
+
+// RT
+void JackGraphManager::ShiftPipeline()
+{
+    JackConnectionManager* manager = ReadCurrentState();
+
+    // A raw copy of the whole port type size : MIDI buffers only use offsets, but keep event data at the end of their area
+    for (int slot = 0; slot < manager->GetDelayPortCount(); slot++) {
+        JackPort* port = GetPort(manager->GetDelayPort(slot));
+        memcpy(GetDelayBuffer(slot), port->GetBuffer(), GetPortType(port->fTypeId)->size());
+    }
+}
+
 // RT
 int JackGraphManager::ResumeRefNum(JackClientControl* control, JackSynchro* table)
 {
     JackConnectionManager* manager = ReadCurrentState();
-    return manager->ResumeRefNum(control, table, fClientTiming);
+    return manager->ResumeRefNum(control, table, fClientTiming, this);
+}
+
+// RT
+int JackGraphManager::AwakeRefNum(JackClientControl* control, JackSynchro* table)
+{
+    JackConnectionManager* manager = ReadCurrentState();
+    return manager->AwakeRefNum(control, table, fClientTiming, this);
 }
 
 // RT
 int JackGraphManager::SuspendRefNum(JackClientControl* control, JackSynchro* table, long usec)
 {
     JackConnectionManager* manager = ReadCurrentState();
-    return manager->SuspendRefNum(control, table, fClientTiming, usec);
+    if (manager->SuspendRefNum(control, table, fClientTiming, usec) < 0) {
+        return -1;
+    }
+    // The graph may have changed while waiting : wake-up assignments are read from the state of the cycle
+    manager = ReadCurrentState();
+    return manager->WakeAssigned(control, table, fClientTiming, this);
 }
 
 void JackGraphManager::TopologicalSort(std::vector<jack_int_t>& sorted)
@@ -143,6 +211,25 @@ void JackGraphManager::TopologicalSort(std::vector<jack_int_t>& sorted)
     } while (cur_index != next_index); // Until a coherent state has been read
 }
 
+/*!
+\brief Sort the graph and mark the clients whose latency depends on the ones already marked in capture and playback.
+*/
+void JackGraphManager::TopologicalSort(std::vector<jack_int_t>& sorted, bool* capture, bool* playback)
+{
+    UInt16 cur_index;
+    UInt16 next_index;
+
+    do {
+        cur_index = GetCurrentIndex();
+        sorted.clear();
+        JackConnectionManager* manager = ReadCurrentState();
+        manager->TopologicalSort(sorted);
+        // Marking more clients from an incoherent state only causes more notifications
+        manager->PropagateLatency(sorted, capture, playback);
+        next_index = GetCurrentIndex();
+    } while (cur_index != next_index); // Until a coherent state has been read
+}
+
 // Server
 void JackGraphManager::DirectConnect(int ref1, int ref2)
 {
@@ -168,8 +255,25 @@ bool JackGraphManager::IsDirectConnection(int ref1, int ref2)
     return manager->IsDirectConnection(ref1, ref2);
 }
 
+// RT : buffer of the src_index output as seen by the dst input, the previous cycle output between pipeline stages
+void* JackGraphManager::GetSourceBuffer(JackConnectionManager* manager, jack_port_id_t src_index, jack_port_id_t dst_index, jack_nframes_t buffer_size)
+{
+    if (IsDelayBufferConnection(manager, src_index, dst_index)) {
+        return GetDelayBuffer(manager->GetDelaySlot(src_index));
+    } else {
+        return GetBuffer(src_index, buffer_size);
+    }
+}
+
 // RT
 void* JackGraphManager::GetBuffer(jack_port_id_t port_index, jack_nframes_t buffer_size)
+{
+    bool cacheable;
+    return GetBuffer(port_index, buffer_size, &cacheable);
+}
+
+// RT : cacheable is set when the buffer stays the same for the rest of the cycle, so not when it is computed from outputs of the same client
+void* JackGraphManager::GetBuffer(jack_port_id_t port_index, jack_nframes_t buffer_size, bool* cacheable)
 {
     AssertPort(port_index);
     AssertBufferSize(buffer_size);
@@ -180,6 +284,7 @@ void* JackGraphManager::GetBuffer(jack_port_id_t port_index, jack_nframes_t buff
     // This happens when a port has just been unregistered and is still used by the RT code
     if (!port->IsUsed()) {
         jack_log("JackGraphManager::GetBuffer : port = %ld is released state", port_index);
+        *cacheable = false;
         return GetBuffer(0); // port_index 0 is not used
     }
 
@@ -187,47 +292,138 @@ void* JackGraphManager::GetBuffer(jack_port_id_t port_index, jack_nframes_t buff
 
     // Output port
     if (port->fFlags & JackPortIsOutput) {
+        *cacheable = (port->fTied == NO_PORT);
         return (port->fTied != NO_PORT) ? GetBuffer(port->fTied, buffer_size) : GetBuffer(port_index);
     }
 
-    // No connections : return a zero-filled buffer
+    // No connections : return a zero-filled buffer, cleared again by each get since the client may have written in it
     if (len == 0) {
+        *cacheable = false;
         port->ClearBuffer(buffer_size);
         return port->GetBuffer();
 
-    // One connection
-    } else if (len == 1) {
+    // One connection, summing buses apply its gain
+    } else if (len == 1 && !manager->IsBusPort(port_index)) {
         jack_port_id_t src_index = manager->GetPort(port_index, 0);
 
         // Ports in same client : copy the buffer
-        if (GetPort(src_index)->GetRefNum() == port->GetRefNum()) {
+        *cacheable = (GetPort(src_index)->GetRefNum() != port->GetRefNum());
+        if (!*cacheable) {
             void* buffers[1];
             buffers[0] = GetBuffer(src_index, buffer_size);
             port->MixBuffers(buffers, 1, buffer_size);
             return port->GetBuffer();
         // Otherwise, use zero-copy mode, just pass the buffer of the connected (output) port.
         } else {
-            return GetBuffer(src_index, buffer_size);
+            return GetSourceBuffer(manager, src_index, port_index, buffer_size);
         }
 
-    // Multiple connections : mix all buffers
+    // Multiple connections or summing bus, already mixed when the client was made ready
+    } else if (manager->IsMixPort(port_index)) {
+        *cacheable = true;
+        return port->GetBuffer();
+
+    // Multiple connections or summing bus : mix all buffers
     } else {
+        *cacheable = true;
+        MixSourceBuffers(manager, port_index, buffer_size, cacheable);
+        return port->GetBuffer();
+    }
+}
 
-        const jack_int_t* connections = manager->GetConnections(port_index);
-        void* buffers[CONNECTION_NUM_FOR_PORT];
-        jack_port_id_t src_index;
-        int i;
+// RT : mix the outputs connected to an input port in its buffer, cacheable is reset when one of them belongs to the same client
+void JackGraphManager::MixSourceBuffers(JackConnectionManager* manager, jack_port_id_t port_index, jack_nframes_t buffer_size, bool* cacheable)
+{
+    JackPort* port = GetPort(port_index);
+    const jack_int_t* connections = manager->GetConnections(port_index);
+    void* buffers[CONNECTION_NUM_FOR_PORT];
+    jack_port_id_t src_index;
+    int i;
 
-        for (i = 0; (i < CONNECTION_NUM_FOR_PORT) && ((src_index = connections[i]) != EMPTY); i++) {
-            AssertPort(src_index);
-            buffers[i] = GetBuffer(src_index, buffer_size);
+    for (i = 0; (i < CONNECTION_NUM_FOR_PORT) && ((src_index = connections[i]) != EMPTY); i++) {
+        AssertPort(src_index);
+        if (GetPort(src_index)->GetRefNum() == port->GetRefNum()) {
+            *cacheable = false;
         }
+        buffers[i] = GetSourceBuffer(manager, src_index, port_index, buffer_size);
+    }
 
+    if (manager->IsBusPort(port_index)) {
+        MixBusBuffers(manager, port_index, buffers, i, buffer_size);
+    } else {
         port->MixBuffers(buffers, i, buffer_size);
-        return port->GetBuffer();
     }
 }
 
+/*!
+\brief RT : gains are ramped from the previous ones in all mixes of the first cycle using them.
+
+A bus is mixed by one thread in a cycle, either the one making its client ready ("server-mix" mode) or the client
+itself, in any process : the activation of the next cycle orders the fMixCycle and fMixIndex writes of each cycle.
+*/
+void JackGraphManager::MixBusBuffers(JackConnectionManager* manager, jack_port_id_t port_index, void** buffers, int count, jack_nframes_t buffer_size)
+{
+    float from_gains[CONNECTION_NUM_FOR_PORT];
+    float to_gains[CONNECTION_NUM_FOR_PORT];
+    UInt16 gain_index = manager->GetGainIndex(port_index);
+    UInt32 cycle = UInt32(GetEngineControl()->fCurCycleTime);
+
+    if (fMixIndex[port_index] != gain_index) {
+        fMixIndex[port_index] = gain_index;
+        fMixCycle[port_index] = cycle;
+    }
+    bool ramp = (fMixCycle[port_index] == cycle);
+
+    for (int i = 0; i < count; i++) {
+        JackConnectionGain gain = manager->GetGainAt(port_index, i);
+        from_gains[i] = (ramp) ? gain.fPrevGain : gain.fGain;
+        to_gains[i] = gain.fGain;
+    }
+
+    GetPort(port_index)->MixBuffers(buffers, from_gains, to_gains, count, buffer_size);
+}
+
+// RT : called by the thread making the client ready, in any process
+void JackGraphManager::MixInputPorts(JackConnectionManager* manager, int refnum)
+{
+    jack_nframes_t buffer_size = GetEngineControl()->fBufferSize;
+    const jack_int_t* input_ports = manager->GetInputPorts(refnum);
+    jack_port_id_t port_index;
+    bool cacheable;
+
+    for (int i = 0; (i < PORT_NUM_FOR_CLIENT) && ((port_index = input_ports[i]) != EMPTY); i++) {
+        if (manager->IsMixPort(port_index)) {
+            MixSourceBuffers(manager, port_index, buffer_size, &cacheable);
+        }
+    }
+}
+
+/*!
+\brief Server : in "server-mix" mode, client inputs connected to several outputs of other clients, or summing buses, are mixed when the client is made ready.
+
+Drivers and inputs connected to outputs of the same client still mix them when the buffer is asked.
+*/
+void JackGraphManager::UpdateMixPort(JackConnectionManager* manager, jack_port_id_t port_index)
+{
+    JackPort* port = GetPort(port_index);
+    int refnum = port->GetRefNum();
+    bool mix = GetEngineControl()->fServerMix && refnum >= GetEngineControl()->fDriverNum
+        && (manager->Connections(port_index) > 1 || manager->IsBusPort(port_index));
+
+    if (mix) {
+        const jack_int_t* connections = manager->GetConnections(port_index);
+        jack_port_id_t src_index;
+        for (int i = 0; (i < CONNECTION_NUM_FOR_PORT) && ((src_index = connections[i]) != EMPTY); i++) {
+            if (GetPort(src_index)->GetRefNum() == refnum) {
+                mix = false;
+                break;
+            }
+        }
+    }
+
+    manager->SetMixPort(refnum, port_index, mix);
+}
+
 // Server
 int JackGraphManager::RequestMonitor(jack_port_id_t port_index, bool onoff) // Client
 {
@@ -261,6 +457,7 @@ int JackGraphManager::RequestMonitor(jack_port_id_t port_index, bool onoff) // C
 jack_nframes_t JackGraphManager::ComputeTotalLatencyAux(jack_port_id_t port_index, jack_port_id_t src_port_index, JackConnectionManager* manager, int hop_count)
 {
     const jack_int_t* connections = ReadCurrentState()->GetConnections(port_index);
+    bool is_output = (GetPort(port_index)->fFlags & JackPortIsOutput);
     jack_nframes_t max_latency = 0;
     jack_port_id_t dst_index;
 
@@ -274,6 +471,10 @@ jack_nframes_t JackGraphManager::ComputeTotalLatencyAux(jack_port_id_t port_inde
             jack_nframes_t this_latency = (dst_port->fFlags & JackPortIsTerminal)
                                           ? dst_port->GetLatency()
                                           : ComputeTotalLatencyAux(dst_index, port_index, manager, hop_count + 1);
+            // Connections between pipeline stages add one period
+            if (is_output ? IsDelayedConnection(manager, port_index, dst_index) : IsDelayedConnection(manager, dst_index, port_index)) {
+                this_latency += GetEngineControl()->fBufferSize;
+            }
             max_latency = ((max_latency > this_latency) ? max_latency : this_latency);
         }
     }
@@ -314,7 +515,8 @@ int JackGraphManager::ComputeTotalLatencies()
 
 void JackGraphManager::RecalculateLatencyAux(jack_port_id_t port_index, jack_latency_callback_mode_t mode)
 {
-    const jack_int_t* connections = ReadCurrentState()->GetConnections(port_index);
+    JackConnectionManager* manager = ReadCurrentState();
+    const jack_int_t* connections = manager->GetConnections(port_index);
     JackPort* port = GetPort(port_index);
     jack_latency_range_t latency = { UINT32_MAX, 0 };
     jack_port_id_t dst_index;
@@ -326,6 +528,12 @@ void JackGraphManager::RecalculateLatencyAux(jack_port_id_t port_index, jack_lat
 
         dst_port->GetLatencyRange(mode, &other_latency);
 
+        // Connections between pipeline stages add one period
+        if ((port->fFlags & JackPortIsOutput) ? IsDelayedConnection(manager, port_index, dst_index) : IsDelayedConnection(manager, dst_index, port_index)) {
+            other_latency.min += GetEngineControl()->fBufferSize;
+            other_latency.max += GetEngineControl()->fBufferSize;
+        }
+
         if (other_latency.max > latency.max) {
 			latency.max = other_latency.max;
         }
@@ -641,6 +849,8 @@ int JackGraphManager::Connect(jack_port_id_t port_src, jack_port_id_t port_dst)
     res = manager->Connect(port_dst, port_src);
     if (res < 0) {
         jack_error("JackGraphManager::Connect failed port_dst = %ld port_src = %ld", port_dst, port_src);
+        // Full table : no connection known from one side only
+        manager->Disconnect(port_src, port_dst);
         goto end;
     }
 
@@ -650,6 +860,7 @@ int JackGraphManager::Connect(jack_port_id_t port_src, jack_port_id_t port_dst)
     } else {
         manager->IncDirectConnection(port_src, port_dst);
     }
+    UpdateMixPort(manager, port_dst);
 
 end:
     WriteNextStateStop();
@@ -696,6 +907,7 @@ int JackGraphManager::Disconnect(jack_port_id_t port_src, jack_port_id_t port_ds
     } else {
         manager->DecDirectConnection(port_src, port_dst);
     }
+    UpdateMixPort(manager, port_dst);
 
 end:
     WriteNextStateStop();
@@ -709,6 +921,44 @@ int JackGraphManager::IsConnected(jack_port_id_t port_src, jack_port_id_t port_d
     return manager->IsConnected(port_src, port_dst);
 }
 
+// Server
+int JackGraphManager::SetConnectionGain(jack_port_id_t port_src, jack_port_id_t port_dst, float gain)
+{
+    JackConnectionManager* manager = WriteNextStateStart();
+    jack_log("JackGraphManager::SetConnectionGain port_src = %ld port_dst = %ld gain = %f", port_src, port_dst, gain);
+    int res = 0;
+
+    if (!manager->IsConnected(port_src, port_dst)) {
+        jack_error("JackGraphManager::SetConnectionGain not connected port_src = %ld port_dst = %ld", port_src, port_dst);
+        res = -1;
+        goto end;
+    }
+    if (GetPortType(GetPort(port_dst)->fTypeId)->mixdown_gain == NULL) {
+        jack_error("JackGraphManager::SetConnectionGain port type without gain port_dst = %ld", port_dst);
+        res = -1;
+        goto end;
+    }
+
+    // The state being written is switched to with the next index
+    res = manager->SetGain(port_src, port_dst, gain, GetCurrentIndex() + 1);
+    if (res < 0) {
+        jack_error("JackGraphManager::SetConnectionGain failed port_src = %ld port_dst = %ld", port_src, port_dst);
+        goto end;
+    }
+    UpdateMixPort(manager, port_dst);
+
+end:
+    WriteNextStateStop();
+    return res;
+}
+
+// Client
+int JackGraphManager::GetConnectionGain(jack_port_id_t port_src, jack_port_id_t port_dst, float* gain)
+{
+    JackConnectionManager* manager = ReadCurrentState();
+    return manager->GetGain(port_src, port_dst, gain);
+}
+
 // Server
 int JackGraphManager::CheckPorts(jack_port_id_t port_src, jack_port_id_t port_dst)
 {
@@ -910,6 +1160,7 @@ void JackGraphManager::Restore(JackConnectionManager* src)
 {
     JackConnectionManager* manager = WriteNextStateStart();
     memcpy(manager, src, sizeof(JackConnectionManager));
+    manager->SetChanged();
     WriteNextStateStop();
 }
 
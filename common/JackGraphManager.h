@@ -43,7 +43,10 @@ class SERVER_EXPORT JackGraphManager : public JackShmMem, public JackAtomicState
     private:
 
         unsigned int fPortMax;
-        JackClientTiming fClientTiming[CLIENT_NUM];
+        alignas(JACK_CACHE_LINE_SIZE) JackClientTiming fClientTiming[CLIENT_NUM];
+        int fDelayBufferNum;       // Previous cycle output of ports connected to a later pipeline stage, stored after fPortArray
+        UInt32 fMixCycle[PORT_NUM_MAX];     // Cycle ramping the gains of each summing bus, written in RT : not part of the state
+        UInt16 fMixIndex[PORT_NUM_MAX];     // Gain index of the last mix of each summing bus, written in RT : not part of the state
         JackPort fPortArray[0];    // The actual size depends of port_max, it will be dynamically computed and allocated using "placement" new
 
         void AssertPort(jack_port_id_t port_index);
@@ -51,13 +54,20 @@ class SERVER_EXPORT JackGraphManager : public JackShmMem, public JackAtomicState
         void GetConnectionsAux(JackConnectionManager* manager, const char** res, jack_port_id_t port_index);
         void GetPortsAux(const char** matching_ports, const char* port_name_pattern, const char* type_name_pattern, unsigned long flags);
         jack_default_audio_sample_t* GetBuffer(jack_port_id_t port_index);
+        jack_default_audio_sample_t* GetDelayBuffer(int slot);
+        void* GetSourceBuffer(JackConnectionManager* manager, jack_port_id_t src_index, jack_port_id_t dst_index, jack_nframes_t buffer_size);
+        void MixSourceBuffers(JackConnectionManager* manager, jack_port_id_t port_index, jack_nframes_t buffer_size, bool* cacheable);
+        void MixBusBuffers(JackConnectionManager* manager, jack_port_id_t port_index, void** buffers, int count, jack_nframes_t buffer_size);
+        void UpdateMixPort(JackConnectionManager* manager, jack_port_id_t port_index);
+        bool IsDelayedConnection(JackConnectionManager* manager, jack_port_id_t port_src, jack_port_id_t port_dst);
+        bool IsDelayBufferConnection(JackConnectionManager* manager, jack_port_id_t port_src, jack_port_id_t port_dst);
         void* GetBufferAux(JackConnectionManager* manager, jack_port_id_t port_index, jack_nframes_t frames);
         jack_nframes_t ComputeTotalLatencyAux(jack_port_id_t port_index, jack_port_id_t src_port_index, JackConnectionManager* manager, int hop_count);
         void RecalculateLatencyAux(jack_port_id_t port_index, jack_latency_callback_mode_t mode);
 
     public:
 
-        JackGraphManager(int port_max);
+        JackGraphManager(int port_max, int delay_buffer_num);
         ~JackGraphManager()
         {}
 
@@ -84,6 +94,8 @@ class SERVER_EXPORT JackGraphManager : public JackShmMem, public JackAtomicState
         int Connect(jack_port_id_t src_index, jack_port_id_t dst_index);
         int Disconnect(jack_port_id_t src_index, jack_port_id_t dst_index);
         int IsConnected(jack_port_id_t port_src, jack_port_id_t port_dst);
+        int SetConnectionGain(jack_port_id_t port_src, jack_port_id_t port_dst, float gain);
+        int GetConnectionGain(jack_port_id_t port_src, jack_port_id_t port_dst, float* gain);
 
         // RT, client
         int GetConnectionsNum(jack_port_id_t port_index)
@@ -115,16 +127,21 @@ class SERVER_EXPORT JackGraphManager : public JackShmMem, public JackAtomicState
 
         // Buffer management
         void* GetBuffer(jack_port_id_t port_index, jack_nframes_t frames);
+        void* GetBuffer(jack_port_id_t port_index, jack_nframes_t frames, bool* cacheable);
+        void MixInputPorts(JackConnectionManager* manager, int refnum);
 
         // Activation management
         void RunCurrentGraph();
         bool RunNextGraph();
         bool IsFinishedGraph();
+        void ShiftPipeline();
 
         void InitRefNum(int refnum);
         int ResumeRefNum(JackClientControl* control, JackSynchro* table);
         int SuspendRefNum(JackClientControl* control, JackSynchro* table, long usecs);
+        int AwakeRefNum(JackClientControl* control, JackSynchro* table);
         void TopologicalSort(std::vector<jack_int_t>& sorted);
+        void TopologicalSort(std::vector<jack_int_t>& sorted, bool* capture, bool* playback);
 
         JackClientTiming* GetClientTiming(int refnum)
         {
@@ -134,7 +151,7 @@ class SERVER_EXPORT JackGraphManager : public JackShmMem, public JackAtomicState
         void Save(JackConnectionManager* dst);
         void Restore(JackConnectionManager* src);
 
-        static JackGraphManager* Allocate(int port_max);
+        static JackGraphManager* Allocate(int port_max, int delay_buffer_num = 0);
         static void Destroy(JackGraphManager* manager);
 
 } POST_PACKED_STRUCTURE;
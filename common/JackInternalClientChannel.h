@@ -94,6 +94,10 @@ class JackInternalClientChannel : public detail::JackClientChannelInterface
         {
             *result = fEngine->PortRename(refnum, port, name);
         }
+        void SetConnectionGain(int refnum, const char* src, const char* dst, float gain, int* result)
+        {
+            *result = fEngine->SetConnectionGain(refnum, src, dst, gain);
+        }
 
         void SetBufferSize(jack_nframes_t buffer_size, int* result)
         {
@@ -238,6 +238,14 @@ class SERVER_EXPORT JackLockedEngine
             CATCH_EXCEPTION_RETURN
         }
 
+        int SetConnectionGain(int refnum, const char* src, const char* dst, float gain)
+        {
+            TRY_CALL
+            JackLock lock(&fEngine);
+            return (fEngine.CheckClient(refnum)) ? fEngine.SetConnectionGain(refnum, src, dst, gain) : -1;
+            CATCH_EXCEPTION_RETURN
+        }
+
         int PortRename(int refnum, jack_port_id_t port, const char* name)
         {
             TRY_CALL
@@ -23,28 +23,474 @@
 #include "JackGlobals.h"
 #include "JackError.h"
 #include "JackTime.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 
 namespace Jack
 {
 
+enum JackFormatLength {
+    kLengthNone,
+    kLengthChar,
+    kLengthShort,
+    kLengthLong,
+    kLengthLongLong,
+    kLengthMax,
+    kLengthSize,
+    kLengthPtrDiff,
+    kLengthLongDouble,
+};
+
+struct JackFormatSpec
+{
+    const char* fBegin;     // on the '%'
+    const char* fLength;    // on the length modifier, or the conversion
+    int fStars;             // '*' width and precision taking an int argument
+    int fLengthType;
+    char fConversion;
+};
+
+union JackMessageArg
+{
+    long long i;
+    unsigned long long u;
+    double d;
+    const void* p;
+};
+
+union JackMessageRecordBuffer
+{
+    JackMessageRecord fRecord;
+    JackMessageArg fAlign;
+    char fBuffer[MB_RECORD_SIZE];
+};
+
+static const char* ParseFormatSpec(const char* fmt, JackFormatSpec* spec)
+{
+    spec->fBegin = fmt++;
+    spec->fStars = 0;
+
+    while (*fmt && strchr("-+ #0'", *fmt)) {
+        fmt++;
+    }
+    if (*fmt == '*') {
+        spec->fStars++;
+        fmt++;
+    }
+    while (*fmt >= '0' && *fmt <= '9') {
+        fmt++;
+    }
+    if (*fmt == '.') {
+        fmt++;
+        if (*fmt == '*') {
+            spec->fStars++;
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            fmt++;
+        }
+    }
+
+    spec->fLength = fmt;
+    switch (*fmt) {
+        case 'h':
+            spec->fLengthType = (*++fmt == 'h') ? (fmt++, kLengthChar) : kLengthShort;
+            break;
+        case 'l':
+            spec->fLengthType = (*++fmt == 'l') ? (fmt++, kLengthLongLong) : kLengthLong;
+            break;
+        case 'q':
+            spec->fLengthType = kLengthLongLong;
+            fmt++;
+            break;
+        case 'j':
+            spec->fLengthType = kLengthMax;
+            fmt++;
+            break;
+        case 'z':
+            spec->fLengthType = kLengthSize;
+            fmt++;
+            break;
+        case 't':
+            spec->fLengthType = kLengthPtrDiff;
+            fmt++;
+            break;
+        case 'L':
+            spec->fLengthType = kLengthLongDouble;
+            fmt++;
+            break;
+        default:
+            spec->fLengthType = kLengthNone;
+            break;
+    }
+
+    spec->fConversion = *fmt;
+    return (*fmt) ? fmt + 1 : fmt;
+}
+
+/*!
+\brief Copy a string truncated to the message length limit, returns its length.
+*/
+static size_t CopyText(char* dst, const char* src)
+{
+    size_t len = (src) ? strnlen(src, MB_BUFFERSIZE - 1) : 0;
+    memcpy(dst, src, len);
+    dst[len] = 0;
+    return len;
+}
+
+/*!
+\brief Copy the raw arguments after the record text, returns false when the format cannot be recorded.
+
+Called in RT threads : no formatting, only the arguments and the strings are copied.
+*/
+static bool EncodeArguments(JackMessageRecord* record, const char* fmt, va_list ap)
+{
+    char* slot = (char*)(record + 1) + record->fText;
+    char* end = (char*)record + MB_RECORD_SIZE;
+    int args = 0;
+    JackFormatSpec spec;
+
+    while ((fmt = strchr(fmt, '%')) != NULL) {
+        fmt = ParseFormatSpec(fmt, &spec);
+        if (spec.fConversion == '%') {
+            continue;
+        }
+        args += spec.fStars + 1;
+        if (args > MB_ARGS || slot + sizeof(JackMessageArg) * (spec.fStars + 1) > end) {
+            return false;
+        }
+
+        for (int i = 0; i < spec.fStars; i++) {
+            ((JackMessageArg*)slot)->i = va_arg(ap, int);
+            slot += sizeof(JackMessageArg);
+        }
+
+        JackMessageArg* arg = (JackMessageArg*)slot;
+        slot += sizeof(JackMessageArg);
+
+        switch (spec.fConversion) {
+
+            case 'd':
+            case 'i':
+                switch (spec.fLengthType) {
+                    case kLengthChar: arg->i = (signed char)va_arg(ap, int); break;
+                    case kLengthShort: arg->i = (short)va_arg(ap, int); break;
+                    case kLengthLong: arg->i = va_arg(ap, long); break;
+                    case kLengthLongLong: arg->i = va_arg(ap, long long); break;
+                    case kLengthMax: arg->i = va_arg(ap, intmax_t); break;
+                    case kLengthSize: arg->i = (ptrdiff_t)va_arg(ap, size_t); break;
+                    case kLengthPtrDiff: arg->i = va_arg(ap, ptrdiff_t); break;
+                    default: arg->i = va_arg(ap, int); break;
+                }
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                switch (spec.fLengthType) {
+                    case kLengthChar: arg->u = (unsigned char)va_arg(ap, unsigned int); break;
+                    case kLengthShort: arg->u = (unsigned short)va_arg(ap, unsigned int); break;
+                    case kLengthLong: arg->u = va_arg(ap, unsigned long); break;
+                    case kLengthLongLong: arg->u = va_arg(ap, unsigned long long); break;
+                    case kLengthMax: arg->u = va_arg(ap, uintmax_t); break;
+                    case kLengthSize: arg->u = va_arg(ap, size_t); break;
+                    case kLengthPtrDiff: arg->u = (size_t)va_arg(ap, ptrdiff_t); break;
+                    default: arg->u = va_arg(ap, unsigned int); break;
+                }
+                break;
+
+            case 'c':
+                if (spec.fLengthType != kLengthNone) {
+                    return false;
+                }
+                arg->i = va_arg(ap, int);
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                arg->d = (spec.fLengthType == kLengthLongDouble) ? (double)va_arg(ap, long double) : va_arg(ap, double);
+                break;
+
+            case 'p':
+                arg->p = va_arg(ap, void*);
+                break;
+
+            case 's': {
+                if (spec.fLengthType != kLengthNone) {
+                    return false;
+                }
+                const char* str = va_arg(ap, const char*);
+                if (str == NULL) {
+                    str = "(null)";
+                }
+                long long len = 0;
+                long long max = end - slot - 1;
+                if (max < 0) {
+                    return false;
+                } else if (max > MB_BUFFERSIZE - 1) {
+                    max = MB_BUFFERSIZE - 1;
+                }
+                while (len < max && str[len]) {
+                    slot[len] = str[len];
+                    len++;
+                }
+                slot[len] = 0;
+                arg->i = len;
+                slot += MB_ALIGN(len + 1);
+                break;
+            }
+
+            default:
+                // %n, %m or an unknown conversion : let the caller format it
+                return false;
+        }
+    }
+
+    record->fArgs = args;
+    record->fSize = MB_ALIGN(slot - (char*)record);
+    return true;
+}
+
+template <typename T>
+static int FormatArgument(char* buffer, size_t size, const char* fmt, const int* stars, int count, T value)
+{
+    switch (count) {
+        case 0: return snprintf(buffer, size, fmt, value);
+        case 1: return snprintf(buffer, size, fmt, stars[0], value);
+        default: return snprintf(buffer, size, fmt, stars[0], stars[1], value);
+    }
+}
+
+/*!
+\brief Format a record in the buffer thread.
+*/
+static void FormatRecord(const JackMessageRecord* record, char* buffer, size_t size)
+{
+    const char* prefix = (const char*)(record + 1);
+    const char* text = prefix + strlen(prefix) + 1;
+    size_t len = snprintf(buffer, size, "%s", prefix);
+
+    if (len >= size) {
+        return;
+    }
+
+    if (record->fArgs == MB_TEXT) {
+        snprintf(buffer + len, size - len, "%s", text);
+        return;
+    }
+
+    const char* fmt = text;
+    const char* slot = (const char*)(record + 1) + record->fText;
+    JackFormatSpec spec;
+
+    while (*fmt && len < size - 1) {
+
+        if (*fmt != '%') {
+            buffer[len++] = *fmt++;
+            continue;
+        }
+
+        fmt = ParseFormatSpec(fmt, &spec);
+        if (spec.fConversion == '%') {
+            buffer[len++] = '%';
+            continue;
+        }
+
+        int stars[2];
+        for (int i = 0; i < spec.fStars; i++) {
+            stars[i] = (int)((const JackMessageArg*)slot)->i;
+            slot += sizeof(JackMessageArg);
+        }
+        const JackMessageArg* arg = (const JackMessageArg*)slot;
+        slot += sizeof(JackMessageArg);
+
+        // Flags, width and precision are kept, the length modifier is the one of the stored argument
+        char conversion[32];
+        size_t flags = spec.fLength - spec.fBegin;
+        if (flags + 4 > sizeof(conversion)) {
+            break;
+        }
+        memcpy(conversion, spec.fBegin, flags);
+
+        int res;
+        switch (spec.fConversion) {
+
+            case 'd':
+            case 'i':
+                snprintf(conversion + flags, sizeof(conversion) - flags, "ll%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, arg->i);
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                snprintf(conversion + flags, sizeof(conversion) - flags, "ll%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, arg->u);
+                break;
+
+            case 'c':
+                snprintf(conversion + flags, sizeof(conversion) - flags, "%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, (int)arg->i);
+                break;
+
+            case 'p':
+                snprintf(conversion + flags, sizeof(conversion) - flags, "%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, arg->p);
+                break;
+
+            case 's':
+                snprintf(conversion + flags, sizeof(conversion) - flags, "%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, slot);
+                slot += MB_ALIGN(arg->i + 1);
+                break;
+
+            default:
+                snprintf(conversion + flags, sizeof(conversion) - flags, "%c", spec.fConversion);
+                res = FormatArgument(buffer + len, size - len, conversion, stars, spec.fStars, arg->d);
+                break;
+        }
+
+        if (res < 0) {
+            break;
+        }
+        len += ((size_t)res < size - len) ? res : size - len - 1;
+    }
+
+    buffer[len] = 0;
+}
+
+JackMessageRing::JackMessageRing(UInt32 size, bool shared)
+    :fBuffer((char*)calloc(1, size)),
+    fSize(size),
+    fWrite(0),
+    fRead(0),
+    fShared(shared)
+{}
+
+JackMessageRing::~JackMessageRing()
+{
+    free(fBuffer);
+}
+
+void JackMessageRing::CopyIn(UInt32 pos, const char* src, UInt32 size)
+{
+    UInt32 offset = pos & (fSize - 1);
+    UInt32 first = (size < fSize - offset) ? size : fSize - offset;
+    memcpy(fBuffer + offset, src, first);
+    memcpy(fBuffer, src + first, size - first);
+}
+
+void JackMessageRing::CopyOut(UInt32 pos, char* dst, UInt32 size)
+{
+    UInt32 offset = pos & (fSize - 1);
+    UInt32 first = (size < fSize - offset) ? size : fSize - offset;
+    memcpy(dst, fBuffer + offset, first);
+    memcpy(dst + first, fBuffer, size - first);
+    if (fShared) {
+        // A cleared size means "not written yet" for the next records
+        memset(fBuffer + offset, 0, first);
+        memset(fBuffer, 0, size - first);
+    }
+}
+
+bool JackMessageRing::Write(const JackMessageRecord* record)
+{
+    UInt32 size = record->fSize;
+    UInt32 write;
+
+    if (fShared) {
+        // Reserve space, then publish the record by writing its size last
+        do {
+            write = fWrite;
+            JACK_ACQ_FENCE();
+            if (size > fSize - (write - fRead)) {
+                return false;
+            }
+        } while (!CAS(write, write + size, &fWrite));
+        CopyIn(write + sizeof(UInt32), (const char*)record + sizeof(UInt32), size - sizeof(UInt32));
+        JACK_REL_FENCE();
+        *(volatile UInt32*)(fBuffer + (write & (fSize - 1))) = size;
+    } else {
+        write = fWrite;
+        JACK_ACQ_FENCE();
+        if (size > fSize - (write - fRead)) {
+            return false;
+        }
+        CopyIn(write, (const char*)record, size);
+        JACK_REL_FENCE();
+        fWrite = write + size;
+    }
+
+    return true;
+}
+
+bool JackMessageRing::Read(JackMessageRecord* record)
+{
+    UInt32 read = fRead;
+    UInt32 size;
+
+    if (fShared) {
+        size = *(volatile UInt32*)(fBuffer + (read & (fSize - 1)));
+        if (size == 0) {
+            return false;
+        }
+    } else {
+        if (read == fWrite) {
+            return false;
+        }
+        size = *(UInt32*)(fBuffer + (read & (fSize - 1)));
+    }
+
+    JACK_ACQ_FENCE();
+    CopyOut(read, (char*)record, size);
+    JACK_REL_FENCE();
+    fRead = read + size;
+    return true;
+}
+
 JackMessageBuffer* JackMessageBuffer::fInstance = NULL;
+intptr_t JackMessageBuffer::fGenerations = 0;
 
 JackMessageBuffer::JackMessageBuffer()
     :fInit(NULL),
     fInitArg(NULL),
+    fSpill(MB_SPILL_SIZE, true),
     fThread(this),
     fGuard(),
-    fInBuffer(0),
-    fOutBuffer(0),
+    fPending(false),
     fOverruns(0),
-    fRunning(false)
+    fSpills(0),
+    fRunning(false),
+    fGeneration(++fGenerations)
 {
     static_assert(offsetof(JackMessageBuffer, fOverruns) % sizeof(fOverruns) == 0,
                   "fOverruns must be aligned within JackMessageBuffer");
+    static_assert(sizeof(JackMessageRecord) % 8 == 0,
+                  "JackMessageRecord size must keep records aligned");
+    for (int i = 0; i < MB_THREADS; i++) {
+        fRings[i] = NULL;
+        fSpilled[i] = 0;
+        fSpillRead[i] = 0;
+        fReleased[i] = false;
+    }
 }
 
 JackMessageBuffer::~JackMessageBuffer()
-{}
+{
+    for (int i = 0; i < MB_THREADS; i++) {
+        delete fRings[i];
+    }
+}
 
 bool JackMessageBuffer::Start()
 {
@@ -65,6 +511,9 @@ bool JackMessageBuffer::Stop()
     } else {
         jack_log("no message buffer overruns");
     }
+    if (fSpills > 0) {
+        jack_log("%d messages written in the message spill buffer", fSpills);
+    }
 
     if (fGuard.Lock()) {
         fRunning = false;
@@ -79,32 +528,216 @@ bool JackMessageBuffer::Stop()
     return true;
 }
 
+void JackMessageBuffer::Log(const JackMessageRecord* record)
+{
+    char buffer[MB_BUFFERSIZE];
+    FormatRecord(record, buffer, sizeof(buffer));
+    jack_log_function(record->fLevel, buffer);
+}
+
 void JackMessageBuffer::Flush()
 {
-    while (fOutBuffer != fInBuffer) {
-        jack_log_function(fBuffers[fOutBuffer].level, fBuffers[fOutBuffer].message);
-        fOutBuffer = MB_NEXT(fOutBuffer);
+    JackMessageRecordBuffer record;
+
+    fPending = false;
+
+    // Owned rings records are older than the spilled ones of the same thread
+    for (int i = 0; i < MB_THREADS; i++) {
+        JackMessageRing* ring = fRings[i];
+        JACK_ACQ_FENCE();
+        if (ring) {
+            while (ring->Read(&record.fRecord)) {
+                Log(&record.fRecord);
+            }
+        }
+    }
+
+    while (fSpill.Read(&record.fRecord)) {
+        Log(&record.fRecord);
+        if (record.fRecord.fRing < MB_THREADS) {
+            JACK_REL_FENCE();
+            fSpillRead[record.fRecord.fRing]++;
+        }
+    }
+
+    // Rings of exited threads, once all their records are read : AddThread can then give them to new threads
+    for (int i = 0; i < MB_THREADS; i++) {
+        JackMessageRing* ring = fRings[i];
+        if (ring && fReleased[i] && fSpilled[i] == fSpillRead[i]) {
+            JACK_ACQ_FENCE();
+            while (ring->Read(&record.fRecord)) {
+                Log(&record.fRecord);
+            }
+            fReleased[i] = false;
+            JACK_REL_FENCE();
+            fRings[i] = NULL;
+            delete ring;
+        }
     }
 }
 
-void JackMessageBuffer::AddMessage(int level, const char *message)
+JackMessageRing* JackMessageBuffer::GetRing(int* index)
+{
+    intptr_t key = (intptr_t)jack_tls_get(JackGlobals::fKeyLogRing);
+    if (key / MB_THREADS == fGeneration) {
+        *index = key % MB_THREADS;
+        return fRings[*index];
+    } else {
+        *index = MB_THREADS;
+        return NULL;
+    }
+}
+
+/*!
+\brief Gives its ring back when the thread exits.
+*/
+struct JackMessageRingOwner
+{
+    bool fUsed;
+
+    ~JackMessageRingOwner()
+    {
+        if (fUsed && JackMessageBuffer::fInstance) {
+            JackMessageBuffer::fInstance->RemoveThread();
+        }
+    }
+};
+
+static thread_local JackMessageRingOwner gRingOwner;
+
+/*!
+\brief Give its own ring to the calling thread, done when the thread starts using the message buffer.
+*/
+bool JackMessageBuffer::AddThread()
+{
+    int index;
+    if (GetRing(&index)) {
+        return true;
+    }
+
+    bool res = false;
+    if (fGuard.Lock()) {
+        for (int i = 0; i < MB_THREADS; i++) {
+            if (fRings[i] == NULL) {
+                JackMessageRing* ring = new JackMessageRing(MB_RING_SIZE, false);
+                fSpilled[i] = fSpillRead[i] = 0;
+                JACK_REL_FENCE();
+                fRings[i] = ring;
+                res = jack_tls_set(JackGlobals::fKeyLogRing, (void*)(fGeneration * MB_THREADS + i));
+                gRingOwner.fUsed = res;
+                break;
+            }
+        }
+        fGuard.Unlock();
+    }
+    return res;
+}
+
+/*!
+\brief Called when the thread exits : its ring is deleted by the buffer thread once read, messages logged later go to the spill ring.
+*/
+void JackMessageBuffer::RemoveThread()
+{
+    int index;
+    if (GetRing(&index)) {
+        jack_tls_set(JackGlobals::fKeyLogRing, NULL);
+        JACK_REL_FENCE();
+        fReleased[index] = true;
+        fPending = true;
+        if (fGuard.Trylock()) {
+            fGuard.Signal();
+            fGuard.Unlock();
+        }
+    }
+}
+
+void JackMessageBuffer::Write(JackMessageRecord* record)
 {
+    int index;
+    JackMessageRing* ring = GetRing(&index);
+    record->fRing = index;
+
+    // Keep using the spill ring as long as it contains records of this thread, so that order is kept
+    if (ring && fSpilled[index] == fSpillRead[index] && ring->Write(record)) {
+        // Written in owned ring
+    } else {
+        if (fSpill.Write(record)) {
+            if (ring) {
+                fSpilled[index]++;
+            }
+            INC_ATOMIC(&fSpills);
+        } else {
+            INC_ATOMIC(&fOverruns);
+        }
+    }
+
+    // If the lock is taken the buffer thread is flushing, or will see fPending before waiting
+    fPending = true;
     if (fGuard.Trylock()) {
-        fBuffers[fInBuffer].level = level;
-        strncpy(fBuffers[fInBuffer].message, message, MB_BUFFERSIZE);
-        fInBuffer = MB_NEXT(fInBuffer);
         fGuard.Signal();
         fGuard.Unlock();
-    } else {            /* lock collision */
-        INC_ATOMIC(&fOverruns);
     }
 }
 
+void JackMessageBuffer::AddMessage(int level, const char *message)
+{
+    JackMessageRecordBuffer record;
+    char* text = (char*)(&record.fRecord + 1);
+
+    // No prefix
+    text[0] = 0;
+    size_t len = CopyText(text + 1, message);
+    record.fRecord.fLevel = level;
+    record.fRecord.fArgs = MB_TEXT;
+    record.fRecord.fText = MB_ALIGN(len + 2);
+    record.fRecord.fSize = sizeof(JackMessageRecord) + record.fRecord.fText;
+    Write(&record.fRecord);
+}
+
+void JackMessageBuffer::AddMessage(int level, const char *prefix, const char *fmt, va_list ap)
+{
+    JackMessageRecordBuffer record;
+    char* text = (char*)(&record.fRecord + 1);
+    size_t prefix_len = CopyText(text, prefix);
+    char* body = text + prefix_len + 1;
+    bool encoded = false;
+    va_list args;
+
+    record.fRecord.fLevel = level;
+
+    // A truncated format would not match its arguments
+    if (strnlen(fmt, MB_BUFFERSIZE) < MB_BUFFERSIZE) {
+        size_t len = CopyText(body, fmt);
+        record.fRecord.fText = MB_ALIGN(prefix_len + len + 2);
+        va_copy(args, ap);
+        encoded = EncodeArguments(&record.fRecord, body, args);
+        va_end(args);
+    }
+
+    if (!encoded) {
+        // Unsupported format : format it here, still without locking
+        int len = vsnprintf(body, MB_BUFFERSIZE, fmt, ap);
+        if (len < 0) {
+            len = 0;
+            body[0] = 0;
+        } else if (len > MB_BUFFERSIZE - 1) {
+            len = MB_BUFFERSIZE - 1;
+        }
+        record.fRecord.fArgs = MB_TEXT;
+        record.fRecord.fText = MB_ALIGN(prefix_len + len + 2);
+        record.fRecord.fSize = sizeof(JackMessageRecord) + record.fRecord.fText;
+    }
+
+    Write(&record.fRecord);
+}
+
 bool JackMessageBuffer::Execute()
 {
     if (fGuard.Lock()) {
         while (fRunning) {
-            fGuard.Wait();
+            if (!fPending) {
+                fGuard.Wait();
+            }
             /* the client asked for all threads to run a thread
             initialization callback, which includes us.
             */
@@ -114,7 +747,7 @@ bool JackMessageBuffer::Execute()
                 /* and we're done */
                 fGuard.Signal();
             }
-            
+
             /* releasing the mutex reduces contention */
             fGuard.Unlock();
             Flush();
@@ -165,6 +798,21 @@ void JackMessageBufferAdd(int level, const char *message)
     }
 }
 
+void JackMessageBufferAddFormat(int level, const char *prefix, const char *fmt, va_list ap)
+{
+    if (Jack::JackMessageBuffer::fInstance == NULL) {
+        /* Unable to print message with realtime safety. Complain and print it anyway. */
+        jack_log_function(LOG_LEVEL_ERROR, "messagebuffer not initialized, skip message");
+    } else {
+        Jack::JackMessageBuffer::fInstance->AddMessage(level, prefix, fmt, ap);
+    }
+}
+
+bool JackMessageBufferAddThread()
+{
+    return (Jack::JackMessageBuffer::fInstance != NULL && Jack::JackMessageBuffer::fInstance->AddThread());
+}
+
 int JackMessageBuffer::SetInitCallback(JackThreadInitCallback callback, void *arg)
 {
     if (fInstance && callback && fRunning && fGuard.Lock()) {
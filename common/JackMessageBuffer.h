@@ -33,23 +33,74 @@
 #include "JackPlatformPlug.h"
 #include "JackMutex.h"
 #include "JackAtomic.h"
+#include <stdarg.h>
 
 namespace Jack
 {
 
-/* MB_NEXT() relies on the fact that MB_BUFFERS is a power of two */
-#define MB_BUFFERS  128
-#define MB_NEXT(index) ((index+1) & (MB_BUFFERS-1))
-#define MB_BUFFERSIZE   256     /* message length limit */
+#define MB_BUFFERSIZE   256             /* message length limit */
+#define MB_THREADS      16              /* threads having their own ring, others write in the spill ring */
+#define MB_RING_SIZE    (16 * 1024)     /* per thread ring size in bytes, power of two */
+#define MB_SPILL_SIZE   (256 * 1024)    /* shared spill ring size in bytes, power of two */
+#define MB_RECORD_SIZE  1024            /* record size limit */
+#define MB_ARGS         16              /* format arguments limit, longer messages are formatted by the RT thread */
+#define MB_TEXT         0xFFFF          /* record holding an already formatted message */
 
-struct JackMessage
+/* records are 8 bytes aligned so that the header size never wraps */
+#define MB_ALIGN(size) (((size) + 7) & ~7)
+
+/*!
+\brief Message record header, followed by the prefix and the format (or the formatted text), then the raw format arguments.
+
+The prefix and the format are copied : they may be on the caller stack, or in a driver or internal client unloaded
+before the record is formatted. Arguments are stored in 8 bytes slots, strings are copied after a slot holding their
+length.
+*/
+
+struct JackMessageRecord
+{
+    UInt32 fSize;           // whole record size, written last in the spill ring
+    uint8_t fLevel;
+    uint8_t fRing;          // ring of the writing thread, or MB_THREADS
+    UInt16 fArgs;           // argument count or MB_TEXT
+    UInt32 fText;           // prefix and format (or formatted text) size, arguments follow them
+    UInt32 fUnused;         // keeps records 8 bytes aligned
+};
+
+/*!
+\brief Lock-free ring of records with a single consumer.
+
+Owned rings have a single producer, the spill ring is shared by all producers which reserve space with CAS.
+*/
+
+class JackMessageRing
 {
-    int level;
-    char message[MB_BUFFERSIZE];
+
+    private:
+
+        char* fBuffer;
+        UInt32 fSize;
+        volatile UInt32 fWrite;
+        volatile UInt32 fRead;
+        bool fShared;
+
+        void CopyIn(UInt32 pos, const char* src, UInt32 size);
+        void CopyOut(UInt32 pos, char* dst, UInt32 size);
+
+    public:
+
+        JackMessageRing(UInt32 size, bool shared);
+        ~JackMessageRing();
+
+        bool Write(const JackMessageRecord* record);
+        bool Read(JackMessageRecord* record);
 };
 
 /*!
 \brief Message buffer to be used from RT threads.
+
+RT threads only copy the format and its raw arguments in a lock-free ring, formatting is done by the buffer thread.
+A thread writes in its own ring, and spills in the larger shared ring when it is full instead of dropping the message.
 */
 
 class JackMessageBuffer : public JackRunnableInterface
@@ -59,15 +110,25 @@ class JackMessageBuffer : public JackRunnableInterface
 
         volatile JackThreadInitCallback fInit;
         void* fInitArg;
-        JackMessage fBuffers[MB_BUFFERS];
+        JackMessageRing* fRings[MB_THREADS];
+        JackMessageRing fSpill;
         JackThread fThread;
         JackProcessSync fGuard;
-        volatile unsigned int fInBuffer;
-        volatile unsigned int fOutBuffer;
+        volatile UInt32 fSpilled[MB_THREADS];      // records written in the spill ring by the ring owner
+        volatile UInt32 fSpillRead[MB_THREADS];    // and read by the buffer thread
+        volatile bool fReleased[MB_THREADS];       // ring owner exited, the ring is deleted once read
+        volatile bool fPending;
         alignas(SInt32) SInt32 fOverruns;
+        alignas(SInt32) SInt32 fSpills;
         bool fRunning;
+        intptr_t fGeneration;
+
+        static intptr_t fGenerations;
 
         void Flush();
+        void Log(const JackMessageRecord* record);
+        void Write(JackMessageRecord* record);
+        JackMessageRing* GetRing(int* index);
 
         bool Start();
         bool Stop();
@@ -84,6 +145,9 @@ class JackMessageBuffer : public JackRunnableInterface
 	    bool static Destroy();
 
         void AddMessage(int level, const char *message);
+        void AddMessage(int level, const char *prefix, const char *fmt, va_list ap);
+        bool AddThread();
+        void RemoveThread();
         int SetInitCallback(JackThreadInitCallback callback, void *arg);
 
 	    static JackMessageBuffer* fInstance;
@@ -95,6 +159,8 @@ extern "C"
 #endif
 
 void JackMessageBufferAdd(int level, const char *message);
+void JackMessageBufferAddFormat(int level, const char *prefix, const char *fmt, va_list ap);
+bool JackMessageBufferAddThread();
 
 #ifdef __cplusplus
 }
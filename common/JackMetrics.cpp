@@ -0,0 +1,510 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#include "JackMetrics.h"
+#include "JackServerGlobals.h"
+#include "JackEngineControl.h"
+#include "JackLockedEngine.h"
+#include "JackArgParser.h"
+#include "JackTools.h"
+#include "JackTime.h"
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <vector>
+
+#define METRICS_POLL_TIMEOUT 250         /* in ms, bounds the time to stop the thread */
+#define METRICS_REQUEST_SIZE 4096
+#define METRICS_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+namespace Jack
+{
+
+    struct JackMetricsClient {
+
+        int fRefNum;
+        std::string fLabels;
+        JackClientTimingStats fStats;
+
+    };
+
+    // Label values escaping, as required by the OpenMetrics text format
+    static std::string EscapeLabel(const char* value)
+    {
+        std::string res;
+        for (const char* c = value; *c; c++) {
+            switch (*c) {
+                case '\\':
+                    res += "\\\\";
+                    break;
+                case '"':
+                    res += "\\\"";
+                    break;
+                case '\n':
+                    res += "\\n";
+                    break;
+                default:
+                    res += *c;
+                    break;
+            }
+        }
+        return res;
+    }
+
+    JackMetrics::JackMetrics(jack_client_t* client, const JSList* params)
+        :fClient(client), fThread(this), fSocket(-1), fInterval(METRICS_DEFAULT_INTERVAL), fNextSample(0), fXRuns(0)
+    {
+        jack_log("JackMetrics::JackMetrics");
+
+        const JSList* node;
+        const jack_driver_param_t* param;
+        for (node = params; node; node = jack_slist_next(node)) {
+            param = (const jack_driver_param_t*)node->data;
+
+            switch (param->character) {
+                case 'f':
+                    fFile = param->value.str;
+                    break;
+
+                case 's':
+                    fSocketPath = param->value.str;
+                    break;
+
+                case 'i':
+                    fInterval = (param->value.ui > 0) ? param->value.ui : METRICS_DEFAULT_INTERVAL;
+                    break;
+            }
+        }
+
+        // Serve on a socket next to the server one by default
+        if (fFile.empty() && fSocketPath.empty()) {
+            char path[JACK_PATH_MAX + 1];
+            snprintf(path, sizeof(path), "%s/jack_%s_%d_metrics", jack_server_dir,
+                     JackServerGlobals::fInstance->GetEngineControl()->fServerName, JackTools::GetUID());
+            fSocketPath = path;
+        }
+
+        jack_set_xrun_callback(client, XRun, this);
+    }
+
+    JackMetrics::~JackMetrics()
+    {
+        jack_log("JackMetrics::~JackMetrics");
+        fThread.Stop();
+        if (fSocket >= 0) {
+            close(fSocket);
+            unlink(fSocketPath.c_str());
+        }
+    }
+
+    int JackMetrics::Open()
+    {
+        if (!fSocketPath.empty() && !OpenSocket()) {
+            return -1;
+        }
+        if (fThread.StartSync() < 0) {
+            jack_error("Cannot start metrics thread");
+            return -1;
+        }
+        jack_info("Metrics exported%s%s%s%s every %d ms",
+                  fSocketPath.empty() ? "" : " on socket ", fSocketPath.c_str(),
+                  fFile.empty() ? "" : " in file ", fFile.c_str(),
+                  fInterval);
+        return 0;
+    }
+
+    bool JackMetrics::OpenSocket()
+    {
+        struct sockaddr_un addr;
+
+        if (fSocketPath.size() >= sizeof(addr.sun_path)) {
+            jack_error("Metrics socket path %s is too long", fSocketPath.c_str());
+            return false;
+        }
+
+        if ((fSocket = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+            jack_error("Cannot create metrics socket : %s", strerror(errno));
+            return false;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, fSocketPath.c_str());
+        unlink(fSocketPath.c_str());
+
+        if (bind(fSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fSocket, 8) < 0) {
+            jack_error("Cannot bind metrics socket %s : %s", fSocketPath.c_str(), strerror(errno));
+            close(fSocket);
+            fSocket = -1;
+            return false;
+        }
+        return true;
+    }
+
+    int JackMetrics::XRun(void* arg)
+    {
+        JackMetrics* metrics = static_cast<JackMetrics*>(arg);
+        metrics->fXRuns++;
+        return 0;
+    }
+
+    void JackMetrics::Append(const char* format, ...)
+    {
+        char buffer[512];
+        va_list ap;
+        va_start(ap, format);
+        vsnprintf(buffer, sizeof(buffer), format, ap);
+        va_end(ap);
+        fText += buffer;
+    }
+
+    void JackMetrics::SampleHistogram(const char* name, const char* labels, const JackWakeHistogram& histogram)
+    {
+        UInt32 count = 0;
+        const char* sep = (labels[0]) ? "," : "";
+
+        // Buckets are cumulative in OpenMetrics, the last one has no upper bound
+        for (int i = 0; i < WAKE_HISTOGRAM_BUCKETS - 1; i++) {
+            count += histogram.fBuckets[i];
+            Append("%s_bucket{%s%sle=\"%g\"} %u\n", name, labels, sep, double(1 << i) * 1e-6, count);
+        }
+        count += histogram.fBuckets[WAKE_HISTOGRAM_BUCKETS - 1];
+        Append("%s_bucket{%s%sle=\"+Inf\"} %u\n", name, labels, sep, count);
+        if (labels[0]) {
+            Append("%s_count{%s} %u\n", name, labels, count);
+        } else {
+            Append("%s_count %u\n", name, count);
+        }
+    }
+
+    void JackMetrics::SampleClients(JackEngineControl* control)
+    {
+        std::vector<JackMetricsClient> clients;
+
+        for (int i = control->fDriverNum; i < control->fClientEnd; i++) {
+            JackMetricsClient client;
+            if (control->fClientStats[i].Read(&client.fStats) && client.fStats.fName[0] != 0) {
+                client.fRefNum = i;
+                client.fLabels = "client=\"" + EscapeLabel(client.fStats.fName) + "\"";
+                clients.push_back(client);
+            }
+        }
+
+        Append("# TYPE jack_active_clients gauge\n"
+               "# HELP jack_active_clients Number of active clients.\n"
+               "jack_active_clients %d\n", int(clients.size()));
+
+        static const struct {
+            const char* fName;
+            const char* fHelp;
+            size_t fOffset;
+        } gauges[] = {
+            { "jack_client_wake_latency_mean_seconds", "Mean delay between a client being signaled and waking up.",
+              offsetof(JackClientTimingStats, fWakeLatencyMean) },
+            { "jack_client_wake_latency_max_seconds", "Max delay between a client being signaled and waking up.",
+              offsetof(JackClientTimingStats, fWakeLatencyMax) },
+            { "jack_client_wake_latency_p99_seconds", "99th percentile of the delay between a client being signaled and waking up.",
+              offsetof(JackClientTimingStats, fWakeLatencyP99) },
+            { "jack_client_process_duration_mean_seconds", "Mean duration of a client process cycle.",
+              offsetof(JackClientTimingStats, fDurationMean) },
+            { "jack_client_process_duration_max_seconds", "Max duration of a client process cycle.",
+              offsetof(JackClientTimingStats, fDurationMax) },
+            { "jack_client_process_duration_p99_seconds", "99th percentile of the duration of a client process cycle.",
+              offsetof(JackClientTimingStats, fDurationP99) },
+        };
+
+        for (size_t g = 0; g < sizeof(gauges) / sizeof(gauges[0]); g++) {
+            Append("# TYPE %s gauge\n# HELP %s %s\n", gauges[g].fName, gauges[g].fName, gauges[g].fHelp);
+            for (size_t i = 0; i < clients.size(); i++) {
+                float usecs;
+                memcpy(&usecs, (char*)&clients[i].fStats + gauges[g].fOffset, sizeof(float));
+                Append("%s{%s} %g\n", gauges[g].fName, clients[i].fLabels.c_str(), usecs * 1e-6);
+            }
+        }
+
+        Append("# TYPE jack_client_cycles counter\n"
+               "# HELP jack_client_cycles Cycles a client finished since its activation.\n");
+        for (size_t i = 0; i < clients.size(); i++) {
+            Append("jack_client_cycles_total{%s} %u\n", clients[i].fLabels.c_str(), clients[i].fStats.fCycles);
+        }
+
+        Append("# TYPE jack_client_deadline_misses counter\n"
+               "# HELP jack_client_deadline_misses Cycles a client was still waiting or running at the next cycle begin.\n");
+        for (size_t i = 0; i < clients.size(); i++) {
+            Append("jack_client_deadline_misses_total{%s} %u\n", clients[i].fLabels.c_str(), clients[i].fStats.fDeadlineMisses);
+        }
+
+        Append("# TYPE jack_client_wake_delay_seconds histogram\n"
+               "# HELP jack_client_wake_delay_seconds Delay between a client being signaled and waking up.\n");
+        for (size_t i = 0; i < clients.size(); i++) {
+            JackWakeHistogram histogram = control->fClientWake[clients[i].fRefNum];
+            SampleHistogram("jack_client_wake_delay_seconds", clients[i].fLabels.c_str(), histogram);
+        }
+    }
+
+    void JackMetrics::Sample()
+    {
+        JackEngineControl* control = JackServerGlobals::fInstance->GetEngineControl();
+        const char** ports;
+        int port_count = 0;
+        int connection_count = 0;
+
+        fText.clear();
+
+        Append("# TYPE jack_server info\n"
+               "# HELP jack_server JACK server.\n"
+               "jack_server_info{server=\"%s\",version=\"%s\"} 1\n",
+               EscapeLabel(control->fServerName).c_str(), jack_get_version_string());
+
+        Append("# TYPE jack_dsp_load_ratio gauge\n"
+               "# HELP jack_dsp_load_ratio Share of the period used by the graph.\n"
+               "jack_dsp_load_ratio %g\n", control->fCPULoad / 100.);
+
+        Append("# TYPE jack_xruns counter\n"
+               "# HELP jack_xruns Xruns since the exporter was loaded.\n"
+               "jack_xruns_total %u\n", fXRuns);
+
+        Append("# TYPE jack_xrun_max_delay_seconds gauge\n"
+               "# HELP jack_xrun_max_delay_seconds Max delay reported by the driver.\n"
+               "jack_xrun_max_delay_seconds %g\n", control->fMaxDelayedUsecs * 1e-6);
+
+        Append("# TYPE jack_buffer_size_frames gauge\n"
+               "# HELP jack_buffer_size_frames Frames per period.\n"
+               "jack_buffer_size_frames %u\n", control->fBufferSize);
+
+        Append("# TYPE jack_sample_rate_hertz gauge\n"
+               "# HELP jack_sample_rate_hertz Sample rate.\n"
+               "jack_sample_rate_hertz %u\n", control->fSampleRate);
+
+        Append("# TYPE jack_period_seconds gauge\n"
+               "# HELP jack_period_seconds Duration of a period.\n"
+               "jack_period_seconds %g\n", control->fPeriodUsecs * 1e-6);
+
+        Append("# TYPE jack_realtime gauge\n"
+               "# HELP jack_realtime Whether the server runs with real-time scheduling.\n"
+               "jack_realtime %d\n", control->fRealTime ? 1 : 0);
+
+        if ((ports = jack_get_ports(fClient, NULL, NULL, 0)) != NULL) {
+            for (; ports[port_count]; port_count++) {
+                jack_port_t* port = jack_port_by_name(fClient, ports[port_count]);
+                if (port && (jack_port_flags(port) & JackPortIsOutput)) {
+                    const char** connections = jack_port_get_all_connections(fClient, port);
+                    if (connections) {
+                        for (int i = 0; connections[i]; i++) {
+                            connection_count++;
+                        }
+                        jack_free(connections);
+                    }
+                }
+            }
+            jack_free(ports);
+        }
+
+        Append("# TYPE jack_ports gauge\n"
+               "# HELP jack_ports Number of registered ports.\n"
+               "jack_ports %d\n", port_count);
+
+        Append("# TYPE jack_connections gauge\n"
+               "# HELP jack_connections Number of port connections.\n"
+               "jack_connections %d\n", connection_count);
+
+        Append("# TYPE jack_driver_wake_delay_seconds histogram\n"
+               "# HELP jack_driver_wake_delay_seconds Delay of the driver cycle begin after the date predicted from the previous cycles.\n");
+        JackWakeHistogram histogram = control->fDriverWake;
+        SampleHistogram("jack_driver_wake_delay_seconds", "", histogram);
+
+        Append("# TYPE jack_driver_wake_advance_seconds histogram\n"
+               "# HELP jack_driver_wake_advance_seconds Advance of the driver cycle begin before the date predicted from the previous cycles.\n");
+        histogram = control->fDriverWakeEarly;
+        SampleHistogram("jack_driver_wake_advance_seconds", "", histogram);
+
+        SampleClients(control);
+
+        fText += "# EOF\n";
+    }
+
+    // The file is replaced at once, readers never see a partial sample
+    void JackMetrics::WriteFile()
+    {
+        std::string tmp = fFile + ".tmp";
+        FILE* file = fopen(tmp.c_str(), "w");
+
+        if (file == NULL) {
+            jack_error("Cannot open metrics file %s : %s", tmp.c_str(), strerror(errno));
+            return;
+        }
+        bool res = (fwrite(fText.c_str(), 1, fText.size(), file) == fText.size());
+        res = (fclose(file) == 0) && res;
+        if (!res || rename(tmp.c_str(), fFile.c_str()) < 0) {
+            jack_error("Cannot write metrics file %s : %s", fFile.c_str(), strerror(errno));
+            unlink(tmp.c_str());
+        }
+    }
+
+    // Answer any request with the last sample, as a minimal HTTP response
+    void JackMetrics::Serve()
+    {
+        int fd = accept(fSocket, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+
+        struct timeval timeout = { 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        char request[METRICS_REQUEST_SIZE];
+        ssize_t size = recv(fd, request, sizeof(request), 0);
+
+        if (size >= 0) {
+            char header[256];
+            snprintf(header, sizeof(header),
+                     "HTTP/1.0 200 OK\r\nContent-Type: " METRICS_CONTENT_TYPE "\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+                     int(fText.size()));
+            std::string response = std::string(header) + fText;
+            const char* data = response.c_str();
+            size_t remaining = response.size();
+            while (remaining > 0) {
+                ssize_t written = send(fd, data, remaining, MSG_NOSIGNAL);
+                if (written <= 0) {
+                    break;
+                }
+                data += written;
+                remaining -= written;
+            }
+        }
+        close(fd);
+    }
+
+    bool JackMetrics::Execute()
+    {
+        jack_time_t now = GetMicroSeconds();
+        if (now >= fNextSample) {
+            Sample();
+            if (!fFile.empty()) {
+                WriteFile();
+            }
+            fNextSample = now + jack_time_t(fInterval) * 1000;
+        }
+
+        int timeout = int((fNextSample - now) / 1000);
+        if (timeout > METRICS_POLL_TIMEOUT) {
+            timeout = METRICS_POLL_TIMEOUT;
+        }
+
+        if (fSocket >= 0) {
+            struct pollfd pfd = { fSocket, POLLIN, 0 };
+            if (poll(&pfd, 1, timeout) > 0 && (pfd.revents & POLLIN)) {
+                Serve();
+            }
+        } else {
+            JackSleep(timeout * 1000);
+        }
+        return true;
+    }
+
+} // namespace Jack
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "driver_interface.h"
+
+    using namespace Jack;
+
+    static Jack::JackMetrics* metrics = NULL;
+
+    SERVER_EXPORT jack_driver_desc_t* jack_get_descriptor()
+    {
+        jack_driver_desc_t * desc;
+        jack_driver_desc_filler_t filler;
+        jack_driver_param_value_t value;
+
+        desc = jack_driver_descriptor_construct("metrics", JackDriverNone, "server metrics exporter in the OpenMetrics text format", &filler);
+
+        value.str[0] = 0;
+        jack_driver_descriptor_add_parameter(desc, &filler, "file", 'f', JackDriverParamString, &value, NULL, "File to write the metrics to", "File replaced at each sample, e.g. for the Prometheus node exporter textfile collector");
+        jack_driver_descriptor_add_parameter(desc, &filler, "socket", 's', JackDriverParamString, &value, NULL, "UNIX socket to serve the metrics on", "Served as an HTTP response to any request, on a socket next to the server one by default when no file is given");
+
+        value.ui = METRICS_DEFAULT_INTERVAL;
+        jack_driver_descriptor_add_parameter(desc, &filler, "interval", 'i', JackDriverParamUInt, &value, NULL, "Sampling interval in ms", NULL);
+
+        return desc;
+    }
+
+    SERVER_EXPORT int jack_internal_initialize(jack_client_t* jack_client, const JSList* params)
+    {
+        if (metrics) {
+            jack_info("metrics already loaded");
+            return 1;
+        }
+
+        jack_log("Loading metrics");
+        try {
+            metrics = new Jack::JackMetrics(jack_client, params);
+            assert(metrics);
+            if (metrics->Open() < 0) {
+                delete metrics;
+                metrics = NULL;
+                return 1;
+            }
+            return 0;
+        } catch (...) {
+            return 1;
+        }
+    }
+
+    SERVER_EXPORT int jack_initialize(jack_client_t* jack_client, const char* load_init)
+    {
+        JSList* params = NULL;
+        bool parse_params = true;
+        int res = 1;
+        jack_driver_desc_t* desc = jack_get_descriptor();
+
+        Jack::JackArgParser parser ( load_init );
+        if ( parser.GetArgc() > 0 )
+            parse_params = parser.ParseParams ( desc, &params );
+
+        if (parse_params) {
+            res = jack_internal_initialize ( jack_client, params );
+            parser.FreeParams ( params );
+        }
+        return res;
+    }
+
+    SERVER_EXPORT void jack_finish(void* arg)
+    {
+        // No process callback is set, so arg is NULL : delete the loaded instance
+        if (metrics) {
+            jack_log("Unloading metrics");
+            delete metrics;
+            metrics = NULL;
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,82 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#ifndef __JackMetrics__
+#define __JackMetrics__
+
+#include "JackConstants.h"
+#include "JackPlatformPlug.h"
+#include "JackTimingStats.h"
+#include "jack.h"
+#include "jslist.h"
+#include <string>
+
+namespace Jack
+{
+
+#define METRICS_DEFAULT_INTERVAL 1000   /* in ms */
+
+/*!
+\brief Server metrics exporter, in the OpenMetrics text format.
+
+Engine control and graph state are sampled by a low priority thread, never by the RT thread. The last
+sample is written to a file (atomically replaced) and/or served on a UNIX socket, as an HTTP response.
+*/
+
+class JackMetrics : public JackRunnableInterface
+{
+
+    private:
+
+        jack_client_t* fClient;
+        JackThread fThread;
+        std::string fFile;
+        std::string fSocketPath;
+        int fSocket;
+        int fInterval;
+        jack_time_t fNextSample;
+        std::string fText;
+        volatile UInt32 fXRuns;
+
+        void Sample();
+        void SampleClients(struct JackEngineControl* control);
+        void SampleHistogram(const char* name, const char* labels, const JackWakeHistogram& histogram);
+        void WriteFile();
+        bool OpenSocket();
+        void Serve();
+
+        void Append(const char* format, ...);
+
+    public:
+
+        JackMetrics(jack_client_t* jack_client, const JSList* params);
+        ~JackMetrics();
+
+        int Open();
+
+        // JackRunnableInterface interface
+        bool Execute();
+
+        static int XRun(void* arg);
+
+};
+
+}
+
+#endif
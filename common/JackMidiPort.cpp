@@ -156,7 +156,8 @@ const JackPortType gMidiPortType =
     JACK_DEFAULT_MIDI_TYPE,
     MidiBufferSize,
     MidiBufferInit,
-    MidiBufferMixdown
+    MidiBufferMixdown,
+    NULL
 };
 
 } // namespace Jack
@@ -48,6 +48,7 @@ enum NotificationType {
     kSessionCallback = 17,
     kLatencyCallback = 18,
     kPropertyChangeCallback = 19,
+    kProcessEnded = 20,     // Server only : an internal client run by the worker pool ended its process loop
     kMaxNotification = 64  // To keep some room in JackClientControl fCallback table
 };
 
@@ -304,4 +304,14 @@ void JackPort::MixBuffers(void** src_buffers, int src_count, jack_nframes_t buff
     (type->mixdown)(GetBuffer(), src_buffers, src_count, buffer_size);
 }
 
+void JackPort::MixBuffers(void** src_buffers, const float* from_gains, const float* to_gains, int src_count, jack_nframes_t buffer_size)
+{
+    const JackPortType* type = GetPortType(fTypeId);
+    if (type->mixdown_gain) {
+        (type->mixdown_gain)(GetBuffer(), src_buffers, from_gains, to_gains, src_count, buffer_size);
+    } else {
+        (type->mixdown)(GetBuffer(), src_buffers, src_count, buffer_size);
+    }
+}
+
 } // end of namespace
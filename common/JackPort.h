@@ -68,6 +68,7 @@ class SERVER_EXPORT JackPort
         // RT
         void ClearBuffer(jack_nframes_t frames);
         void MixBuffers(void** src_buffers, int src_count, jack_nframes_t frames);
+        void MixBuffers(void** src_buffers, const float* from_gains, const float* to_gains, int src_count, jack_nframes_t frames);
 
     public:
 
@@ -35,6 +35,8 @@ struct JackPortType
     size_t (*size)();
     void (*init)(void* buffer, size_t buffer_size, jack_nframes_t nframes);
     void (*mixdown)(void *mixbuffer, void** src_buffers, int src_count, jack_nframes_t nframes);
+    // Each source gain ramped from from_gains to to_gains over the buffer, NULL when the type has no gain
+    void (*mixdown_gain)(void *mixbuffer, void** src_buffers, const float* from_gains, const float* to_gains, int src_count, jack_nframes_t nframes);
 };
 
 extern jack_port_type_id_t GetPortTypeId(const char* port_type);
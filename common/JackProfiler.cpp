@@ -46,17 +46,16 @@ namespace Jack
         jack_port_unregister(fClient, fDurationPort);
     }
     
-#ifdef JACK_MONITOR
-    JackProfiler::JackProfiler(jack_client_t* client, const JSList* params)
-        :fClient(client), fLastMeasure(NULL)
-#else
     JackProfiler::JackProfiler(jack_client_t* client, const JSList* params)
         :fClient(client)
-#endif
     {
         jack_log("JackProfiler::JackProfiler");
         
         fCPULoadPort = fDriverPeriodPort = fDriverEndPort = NULL;
+        fTracePosition = JackServerGlobals::fInstance->GetEngineControl()->fTrace.GetPosition();
+        memset(&fLastCycle, 0, sizeof(fLastCycle));
+        memset(&fPrevCycle, 0, sizeof(fPrevCycle));
+        memset(fLastClient, 0, sizeof(fLastClient));
       
         const JSList* node;
         const jack_driver_param_t* param;
@@ -100,7 +99,6 @@ namespace Jack
     
     void JackProfiler::ClientRegistration(const char* name, int val, void *arg)
     {
-    #ifdef JACK_MONITOR
         JackProfiler* profiler = static_cast<JackProfiler*>(arg);
         
         // Filter client or "system" name
@@ -118,12 +116,30 @@ namespace Jack
             std::map<std::string, JackProfilerClient*>::iterator it = profiler->fClientTable.find(name);
             if (it != profiler->fClientTable.end()) {
                 jack_log("Client %s removed", name);
-                profiler->fClientTable.erase(it);
                 delete((*it).second);
+                profiler->fClientTable.erase(it);
             }
         }
         profiler->fMutex.Unlock();
-    #endif
+    }
+
+    // Keep the last traced cycle and the last event of each client
+    void JackProfiler::ReadTrace()
+    {
+        JackEngineTrace* trace = &JackServerGlobals::fInstance->GetEngineControl()->fTrace;
+        JackTraceEvent events[CLIENT_NUM + 1];
+        int count;
+
+        while ((count = trace->Read(&fTracePosition, events, CLIENT_NUM + 1, NULL)) > 0) {
+            for (int i = 0; i < count; i++) {
+                if (events[i].fRefNum == TRACE_CYCLE) {
+                    fPrevCycle = fLastCycle;
+                    fLastCycle = events[i];
+                } else if (events[i].fRefNum >= 0 && events[i].fRefNum < CLIENT_NUM) {
+                    fLastClient[events[i].fRefNum] = events[i];
+                }
+            }
+        }
     }
 
     int JackProfiler::Process(jack_nframes_t nframes, void* arg)
@@ -138,17 +154,15 @@ namespace Jack
             }
         }
  
-    #ifdef JACK_MONITOR      
-        
-        JackEngineControl* control = JackServerGlobals::fInstance->GetEngineControl();
-        JackEngineProfiling* engine_profiler = &control->fProfiler;
-        JackTimingMeasure* measure = engine_profiler->GetCurMeasure();
-        
-       if (profiler->fLastMeasure && profiler->fMutex.Trylock()) {
+        profiler->ReadTrace();
+        JackTraceEvent* cycle = &profiler->fLastCycle;
+        float period_usecs = float(cycle->fPeriodUsecs);
+
+        if (profiler->fPrevCycle.fPeriodUsecs > 0 && profiler->fMutex.Trylock()) {
         
             if (profiler->fDriverPeriodPort) {
                 float* buffer_driver_period = (float*)jack_port_get_buffer(profiler->fDriverPeriodPort, nframes);
-                float value1 = (float(measure->fPeriodUsecs) - float(measure->fCurCycleBegin - profiler->fLastMeasure->fCurCycleBegin)) / float(measure->fPeriodUsecs);
+                float value1 = (period_usecs - float(cycle->fSignaledAt - profiler->fPrevCycle.fSignaledAt)) / period_usecs;
                 for (unsigned int i = 0; i < nframes; i++) {
                     buffer_driver_period[i] = value1;
                 }
@@ -156,7 +170,7 @@ namespace Jack
             
             if (profiler->fDriverEndPort) {
                 float* buffer_driver_end_time = (float*)jack_port_get_buffer(profiler->fDriverEndPort, nframes);
-                float value2 = (float(measure->fPrevCycleEnd - profiler->fLastMeasure->fCurCycleBegin)) / float(measure->fPeriodUsecs);
+                float value2 = (float(cycle->fFinishedAt - cycle->fSignaledAt)) / period_usecs;
                 for (unsigned int i = 0; i < nframes; i++) {
                     buffer_driver_end_time[i] = value2;
                 }
@@ -165,20 +179,24 @@ namespace Jack
             std::map<std::string, JackProfilerClient*>::iterator it;
             for (it = profiler->fClientTable.begin(); it != profiler->fClientTable.end(); it++) {
                 int ref = (*it).second->fRefNum;
-                long d5 = long(measure->fClientTable[ref].fSignaledAt - profiler->fLastMeasure->fCurCycleBegin);
-                long d6 = long(measure->fClientTable[ref].fAwakeAt - profiler->fLastMeasure->fCurCycleBegin);
-                long d7 = long(measure->fClientTable[ref].fFinishedAt - profiler->fLastMeasure->fCurCycleBegin);
+                float value3 = 0.f;
+                float value4 = 0.f;
+
+                // Zero if the client did not finish during the last cycle
+                if (ref >= 0 && ref < CLIENT_NUM) {
+                    JackTraceEvent* event = &profiler->fLastClient[ref];
+                    if (event->fCycle == cycle->fCycle && event->fStatus == Finished) {
+                        value3 = float(event->fAwakeAt - event->fSignaledAt) / period_usecs;
+                        value4 = float(event->fFinishedAt - event->fAwakeAt) / period_usecs;
+                    }
+                }
                   
                 float* buffer_scheduling = (float*)jack_port_get_buffer((*it).second->fSchedulingPort, nframes);
-                float value3 = float(d6 - d5) / float(measure->fPeriodUsecs);
-                jack_log("Scheduling %f", value3);
                 for (unsigned int i = 0; i < nframes; i++) {
                     buffer_scheduling[i] = value3;
                 }
                   
                 float* buffer_duration = (float*)jack_port_get_buffer((*it).second->fDurationPort, nframes);
-                float value4 = float(d7 - d6) / float(measure->fPeriodUsecs);
-                jack_log("Duration %f", value4);
                 for (unsigned int i = 0; i < nframes; i++) {
                     buffer_duration[i] = value4;
                 }
@@ -186,8 +204,6 @@ namespace Jack
             
             profiler->fMutex.Unlock();
         }
-        profiler->fLastMeasure = measure;
-    #endif
         return 0;
     }
     
@@ -27,9 +27,7 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <map>
 #include <string>
 
-#ifdef JACK_MONITOR
-#include "JackEngineProfiling.h"
-#endif
+#include "JackEngineTrace.h"
 
 namespace Jack
 {
@@ -59,11 +57,14 @@ class JackProfiler
         jack_port_t* fCPULoadPort;
         jack_port_t* fDriverPeriodPort;
         jack_port_t* fDriverEndPort;
-    #ifdef JACK_MONITOR
-        JackTimingMeasure* fLastMeasure;
+        UInt32 fTracePosition;
+        JackTraceEvent fLastCycle;
+        JackTraceEvent fPrevCycle;
+        JackTraceEvent fLastClient[CLIENT_NUM];
         std::map<std::string, JackProfilerClient*> fClientTable;
         JackMutex fMutex;
-    #endif
+
+        void ReadTrace();
 
     public:
 
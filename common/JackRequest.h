@@ -90,7 +90,8 @@ struct JackRequest
         kGetUUIDByClient = 37,
         kClientHasSessionCallback = 38,
         kComputeTotalLatencies = 39,
-        kPropertyChangeNotify = 40
+        kPropertyChangeNotify = 40,
+        kSetConnectionGain = 41
     };
 
     RequestType fType;
@@ -571,6 +572,56 @@ struct JackPortConnectNameRequest : public JackRequest
 
 };
 
+/*!
+\brief SetConnectionGain request.
+*/
+
+struct JackSetConnectionGainRequest : public JackRequest
+{
+
+    int fRefNum;
+    char fSrc[REAL_JACK_PORT_NAME_SIZE+1];    // port full name
+    char fDst[REAL_JACK_PORT_NAME_SIZE+1];    // port full name
+    float fGain;
+
+    JackSetConnectionGainRequest() : fRefNum(0), fGain(1.f)
+    {
+        memset(fSrc, 0, sizeof(fSrc));
+        memset(fDst, 0, sizeof(fDst));
+    }
+    JackSetConnectionGainRequest(int refnum, const char* src_name, const char* dst_name, float gain)
+        : JackRequest(JackRequest::kSetConnectionGain), fRefNum(refnum), fGain(gain)
+    {
+        memset(fSrc, 0, sizeof(fSrc));
+        memset(fDst, 0, sizeof(fDst));
+        strncpy(fSrc, src_name, sizeof(fSrc)-1);
+        strncpy(fDst, dst_name, sizeof(fDst)-1);
+    }
+
+    int Read(detail::JackChannelTransactionInterface* trans)
+    {
+        CheckSize();
+        CheckRes(trans->Read(&fRefNum, sizeof(int)));
+        CheckRes(trans->Read(&fSrc, sizeof(fSrc)));
+        CheckRes(trans->Read(&fDst, sizeof(fDst)));
+        CheckRes(trans->Read(&fGain, sizeof(float)));
+        return 0;
+    }
+
+    int Write(detail::JackChannelTransactionInterface* trans)
+    {
+        CheckRes(JackRequest::Write(trans, Size()));
+        CheckRes(trans->Write(&fRefNum, sizeof(int)));
+        CheckRes(trans->Write(&fSrc, sizeof(fSrc)));
+        CheckRes(trans->Write(&fDst, sizeof(fDst)));
+        CheckRes(trans->Write(&fGain, sizeof(float)));
+        return 0;
+    }
+
+    int Size() { return sizeof(int) + sizeof(fSrc) + sizeof(fDst) + sizeof(float); }
+
+};
+
 /*!
 \brief PortDisconnectName request.
 */
@@ -137,6 +137,16 @@ int JackRequestDecoder::HandleRequest(detail::JackChannelTransactionInterface* s
             break;
         }
 
+        case JackRequest::kSetConnectionGain: {
+            jack_log("JackRequest::SetConnectionGain");
+            JackSetConnectionGainRequest req;
+            JackResult res;
+            CheckRead(req, socket);
+            res.fResult = fServer->GetEngine()->SetConnectionGain(req.fRefNum, req.fSrc, req.fDst, req.fGain);
+            CheckWriteRefNum("JackRequest::SetConnectionGain", socket);
+            break;
+        }
+
         case JackRequest::kDisconnectNamePorts: {
             jack_log("JackRequest::DisconnectNamePorts");
             JackPortDisconnectNameRequest req;
@@ -42,7 +42,7 @@ namespace Jack
 //----------------
 // Server control 
 //----------------
-JackServer::JackServer(bool sync, bool temporary, int timeout, bool rt, int priority, int port_max, bool verbose, jack_timer_type_t clock, char self_connect_mode, const char* server_name)
+JackServer::JackServer(bool sync, bool temporary, int timeout, bool rt, int priority, int port_max, bool verbose, jack_timer_type_t clock, char self_connect_mode, const char* server_name, int pipeline_stages)
 {
     if (rt) {
         jack_info("JACK server starting in realtime mode with priority %ld", priority);
@@ -52,9 +52,12 @@ JackServer::JackServer(bool sync, bool temporary, int timeout, bool rt, int prio
 
     jack_info("self-connect-mode is \"%s\"", jack_get_self_connect_mode_description(self_connect_mode));
 
-    fGraphManager = JackGraphManager::Allocate(port_max);
+    // Delayed buffers are only needed by pipelined execution
+    fGraphManager = JackGraphManager::Allocate(port_max, (pipeline_stages > 1) ? PIPELINE_BUFFER_NUM : 0);
+    fConnectionState = new JackConnectionManager();
     fMetadata = new JackMetadata(true);
     fEngineControl = new JackEngineControl(sync, temporary, timeout, rt, priority, verbose, clock, server_name);
+    fEngineControl->fPipelineStages = pipeline_stages;
     fEngine = new JackLockedEngine(fGraphManager, GetSynchroTable(), fEngineControl, self_connect_mode);
 
     // A distinction is made between the threaded freewheel driver and the
@@ -68,6 +71,8 @@ JackServer::JackServer(bool sync, bool temporary, int timeout, bool rt, int prio
     fDriverInfo = new JackDriverInfo();
     fAudioDriver = NULL;
     fFreewheel = false;
+    fSavedBufferSize = 0;
+    fRequestedBufferSize = 0;
     JackServerGlobals::fInstance = this;   // Unique instance
     JackServerGlobals::fUserCount = 1;     // One user
     JackGlobals::fVerbose = verbose;
@@ -76,6 +81,7 @@ JackServer::JackServer(bool sync, bool temporary, int timeout, bool rt, int prio
 JackServer::~JackServer()
 {
     JackGraphManager::Destroy(fGraphManager);
+    delete fConnectionState;
     delete fMetadata;
     delete fDriverInfo;
     delete fThreadedFreewheelDriver;
@@ -236,6 +242,16 @@ int JackServer::SetBufferSize(jack_nframes_t buffer_size)
     jack_log("JackServer::SetBufferSize nframes = %ld", buffer_size);
     jack_nframes_t current_buffer_size = fEngineControl->fBufferSize;
 
+    // Clients use the freewheel buffer size : the audio driver one is changed when leaving freewheel mode
+    if (fFreewheel && fSavedBufferSize > 0) {
+        if (fAudioDriver->IsFixedBufferSize()) {
+            jack_log("SetBufferSize: driver only supports a fixed buffer size");
+            return -1;
+        }
+        fRequestedBufferSize = buffer_size;
+        return 0;
+    }
+
     if (current_buffer_size == buffer_size) {
         jack_log("SetBufferSize: requirement for new buffer size equals current value");
         return 0;
@@ -273,8 +289,21 @@ Freewheel mode is implemented by switching from the (audio [slaves] + freewheel)
 
 Normal mode is restored with the connections state valid before freewheel mode was done. Thus one consider that
 no graph state change can be done during freewheel mode.
+
+When a freewheel buffer size is set, clients are switched to it for the duration of freewheel mode, so that each
+cycle (and its synchronization cost) covers more frames. The stopped audio driver keeps its own buffer size, a buffer
+size set during freewheel mode is only given to the audio driver when leaving it.
 */
 
+void JackServer::SetEngineBufferSize(jack_nframes_t buffer_size)
+{
+    jack_log("JackServer::SetEngineBufferSize nframes = %ld", buffer_size);
+    fEngineControl->fBufferSize = buffer_size;
+    fGraphManager->SetBufferSize(buffer_size);
+    fEngineControl->UpdateTimeOut();
+    fEngine->NotifyBufferSize(buffer_size);
+}
+
 int JackServer::SetFreewheel(bool onoff)
 {
     jack_log("JackServer::SetFreewheel is = %ld want = %ld", fFreewheel, onoff);
@@ -285,7 +314,21 @@ int JackServer::SetFreewheel(bool onoff)
         } else {
             fFreewheel = false;
             fThreadedFreewheelDriver->Stop();
-            fGraphManager->Restore(&fConnectionState);   // Restore connection state
+            fGraphManager->Restore(fConnectionState);   // Restore connection state
+            if (fSavedBufferSize > 0) {
+                jack_nframes_t buffer_size = fSavedBufferSize;
+                if (fRequestedBufferSize > 0 && fRequestedBufferSize != fSavedBufferSize) {
+                    if (fAudioDriver->SetBufferSize(fRequestedBufferSize) == 0) {
+                        buffer_size = fRequestedBufferSize;
+                    } else {
+                        jack_error("Cannot SetBufferSize for audio driver, restore current value %ld", fSavedBufferSize);
+                        fAudioDriver->SetBufferSize(fSavedBufferSize);
+                    }
+                }
+                SetEngineBufferSize(buffer_size);
+                fSavedBufferSize = 0;
+                fRequestedBufferSize = 0;
+            }
             fEngine->NotifyFreewheel(onoff);
             fFreewheelDriver->SetMaster(false);
             fAudioDriver->SetMaster(true);
@@ -295,7 +338,7 @@ int JackServer::SetFreewheel(bool onoff)
         if (onoff) {
             fFreewheel = true;
             fAudioDriver->Stop();
-            fGraphManager->Save(&fConnectionState);     // Save connection state
+            fGraphManager->Save(fConnectionState);     // Save connection state
             // Disconnect all slaves
             std::list<JackDriverInterface*> slave_list = fAudioDriver->GetSlaves();
             std::list<JackDriverInterface*>::const_iterator it;
@@ -306,6 +349,11 @@ int JackServer::SetFreewheel(bool onoff)
             }
             // Disconnect master
             fGraphManager->DisconnectAllPorts(fAudioDriver->GetClientControl()->fRefNum);
+            jack_nframes_t buffer_size = fEngineControl->fFreewheelBufferSize;
+            if (buffer_size > 0 && buffer_size != fEngineControl->fBufferSize) {
+                fSavedBufferSize = fEngineControl->fBufferSize;
+                SetEngineBufferSize(buffer_size);
+            }
             fEngine->NotifyFreewheel(onoff);
             fAudioDriver->SetMaster(false);
             fFreewheelDriver->SetMaster(true);
@@ -331,6 +379,15 @@ void JackServer::Notify(int refnum, int notify, int value)
         case kXRunCallback:
             fEngine->NotifyClientXRun(refnum);
             break;
+
+        case kProcessEnded: {
+            // Sent by the worker pool, for an internal client which process callback returned a non-zero status
+            JackClient* client = (refnum >= 0 && refnum < CLIENT_NUM) ? JackGlobals::fClientTable[refnum] : NULL;
+            if (client) {
+                client->ExecuteCycleEnd();
+            }
+            break;
+        }
     }
 }
 
@@ -58,15 +58,18 @@ class SERVER_EXPORT JackServer
         JackGraphManager* fGraphManager;
         JackMetadata* fMetadata;
         JackServerChannel fRequestChannel;
-        JackConnectionManager fConnectionState;
+        JackConnectionManager* fConnectionState;    // Separately allocated : cache line aligned
         JackSynchro fSynchroTable[CLIENT_NUM];
         bool fFreewheel;
+        jack_nframes_t fSavedBufferSize;    // Audio driver buffer size, restored when leaving freewheel mode
+        jack_nframes_t fRequestedBufferSize;    // Buffer size set during freewheel mode, applied to the audio driver when leaving it
 
+        void SetEngineBufferSize(jack_nframes_t buffer_size);
         int InternalClientLoadAux(JackLoadableInternalClient* client, const char* so_name, const char* client_name, int options, int* int_ref, jack_uuid_t uuid, int* status);
 
     public:
 
-        JackServer(bool sync, bool temporary, int timeout, bool rt, int priority, int port_max, bool verbose, jack_timer_type_t clock, char self_connect_mode, const char* server_name);
+        JackServer(bool sync, bool temporary, int timeout, bool rt, int priority, int port_max, bool verbose, jack_timer_type_t clock, char self_connect_mode, const char* server_name, int pipeline_stages = 1);
         ~JackServer();
 
         // Server control
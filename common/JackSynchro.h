@@ -91,6 +91,15 @@ class JackSynchro
             fFlush = mode;
         }
 
+        // Optional bounded spin before sleeping, only supported by some implementations
+        void SetSpin(int usec)
+        {}
+        bool GetSpinStats(unsigned int* spun, unsigned int* slept)
+        {
+            *spun = *slept = 0;
+            return false;
+        }
+
 };
 
 }
@@ -90,6 +90,12 @@ class SERVER_EXPORT JackThreadInterface
         void SetParams(UInt64 period, UInt64 computation, UInt64 constraint) // Empty implementation, will only make sense on OSX...
         {}
 
+        void SetAffinity(const char* cpus) // Empty implementation, will only make sense on Linux...
+        {}
+
+        void SetDeadline(UInt64 runtime, UInt64 deadline, UInt64 period) // Empty implementation, will only make sense on Linux...
+        {}
+
         int Start();
         int StartSync();
         int Kill();
@@ -199,6 +199,7 @@ int JackThreadedDriver::Start()
         jack_error("Cannot start driver");
         return -1;
     }
+    fThread.SetAffinity(GetEngineControl()->fDriverCPUs);
     if (fThread.StartSync() < 0) {
         jack_error("Cannot start thread");
         return -1;
@@ -262,6 +263,10 @@ void JackThreadedDriver::SetRealTime()
         GetEngineControl()->fPeriod = GetEngineControl()->fConstraint = GetEngineControl()->fPeriodUsecs * 1000;
         GetEngineControl()->fComputation = JackTools::ComputationMicroSec(GetEngineControl()->fBufferSize) * 1000;
         fThread.SetParams(GetEngineControl()->fPeriod, GetEngineControl()->fComputation, GetEngineControl()->fConstraint);
+        // Will do "something" on Linux only...
+        if (GetEngineControl()->fDeadlineRuntime > 0) {
+            fThread.SetDeadline(GetEngineControl()->DeadlineRuntime(), GetEngineControl()->fConstraint, GetEngineControl()->fPeriod);
+        }
         if (fThread.AcquireSelfRealTime(GetEngineControl()->fServerPriority) < 0) {
             jack_error("AcquireSelfRealTime error");
         } else {
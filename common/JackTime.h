@@ -33,6 +33,7 @@ extern "C"
     SERVER_EXPORT void EndTime();
     SERVER_EXPORT jack_time_t GetMicroSeconds(void);
     SERVER_EXPORT void JackSleep(long usec);
+    SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec);
 
     void SetClockSource(jack_timer_type_t source);
     const char* ClockSourceName(jack_timer_type_t source);
@@ -29,15 +29,38 @@ Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 namespace Jack
 {
 
-int JackTimedDriver::FirstCycle(jack_time_t cur_time_usec)
+static inline void CPURelax()
 {
-    fAnchorTimeUsec = cur_time_usec;
-    return int((double(fEngineControl->fBufferSize) * 1000000) / double(fEngineControl->fSampleRate));
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && (__ARM_ARCH >= 7))
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
 }
 
-int JackTimedDriver::CurrentCycle(jack_time_t cur_time_usec)
+/*!
+\brief Deadline of the current cycle, computed in integer from the anchor date so that rounding errors do not accumulate.
+*/
+jack_time_t JackTimedDriver::NextDeadline()
+{
+    UInt64 frames = fCycleCount * fEngineControl->fBufferSize;
+    UInt64 rate = fEngineControl->fSampleRate;
+    return fAnchorTimeUsec + (frames / rate) * 1000000 + ((frames % rate) * 1000000) / rate;
+}
+
+void JackTimedDriver::WaitUntil(jack_time_t deadline_usec)
 {
-    return int(((double(fCycleCount) * double(fEngineControl->fBufferSize) * 1000000.) / double(fEngineControl->fSampleRate)) - (cur_time_usec - fAnchorTimeUsec));
+    if (fSpinUsecs > 0) {
+        // Sleep until a bit before the deadline, then spin
+        if (deadline_usec > jack_time_t(fSpinUsecs)) {
+            JackSleepUntil(deadline_usec - fSpinUsecs);
+        }
+        while (GetMicroSeconds() < deadline_usec) {
+            CPURelax();
+        }
+    } else {
+        JackSleepUntil(deadline_usec);
+    }
 }
 
 int JackTimedDriver::Start()
@@ -46,26 +69,38 @@ int JackTimedDriver::Start()
     return JackAudioDriver::Start();
 }
 
+int JackTimedDriver::SetBufferSize(jack_nframes_t buffer_size)
+{
+    // Deadlines are computed again from the next cycle
+    fCycleCount = 0;
+    return JackAudioDriver::SetBufferSize(buffer_size);
+}
+
+int JackTimedDriver::SetSampleRate(jack_nframes_t sample_rate)
+{
+    fCycleCount = 0;
+    return JackAudioDriver::SetSampleRate(sample_rate);
+}
+
 void JackTimedDriver::ProcessWait()
 {
     jack_time_t cur_time_usec = GetMicroSeconds();
-    int wait_time_usec;
 
     if (fCycleCount++ == 0) {
-        wait_time_usec = FirstCycle(cur_time_usec);
-    } else {
-        wait_time_usec = CurrentCycle(cur_time_usec);
+        fAnchorTimeUsec = cur_time_usec;
     }
 
-    if (wait_time_usec < 0) {
+    jack_time_t deadline_usec = NextDeadline();
+
+    if (deadline_usec < cur_time_usec) {
         NotifyXRun(cur_time_usec, float(cur_time_usec - fBeginDateUst));
         fCycleCount = 0;
-        wait_time_usec = 0;
         jack_error("JackTimedDriver::Process XRun = %ld usec", (cur_time_usec - fBeginDateUst));
+        return;
     }
 
-    //jack_log("JackTimedDriver::Process wait_time = %d", wait_time_usec);
-    JackSleep(wait_time_usec);
+    //jack_log("JackTimedDriver::Process deadline = %lld", deadline_usec);
+    WaitUntil(deadline_usec);
 }
 
 int JackWaiterDriver::ProcessNull()
@@ -28,24 +28,29 @@ namespace Jack
 
 /*!
 \brief The timed driver.
+
+Cycle deadlines are absolute dates computed from an anchor date and the cycle count, so that a late
+wake-up does not delay the next cycles. The anchor is reset on xruns, buffer size and sample rate changes.
+The last fSpinUsecs before a deadline can be busy waited, to avoid the sleep wake-up latency.
 */
 
 class SERVER_EXPORT JackTimedDriver : public JackAudioDriver
 {
     protected:
 
-        int fCycleCount;
+        UInt64 fCycleCount;
         jack_time_t fAnchorTimeUsec;
+        int fSpinUsecs;
 
-        int FirstCycle(jack_time_t cur_time);
-        int CurrentCycle(jack_time_t cur_time);
+        jack_time_t NextDeadline();
+        void WaitUntil(jack_time_t deadline_usec);
 
         void ProcessWait();
 
     public:
 
         JackTimedDriver(const char* name, const char* alias, JackLockedEngine* engine, JackSynchro* table)
-                : JackAudioDriver(name, alias, engine, table), fCycleCount(0), fAnchorTimeUsec(0)
+                : JackAudioDriver(name, alias, engine, table), fCycleCount(0), fAnchorTimeUsec(0), fSpinUsecs(0)
         {}
         virtual ~JackTimedDriver()
         {}
@@ -58,6 +63,14 @@ class SERVER_EXPORT JackTimedDriver : public JackAudioDriver
 
         int Start();
 
+        int SetBufferSize(jack_nframes_t buffer_size);
+        int SetSampleRate(jack_nframes_t sample_rate);
+
+        void SetSpin(int usecs)
+        {
+            fSpinUsecs = usecs;
+        }
+
 };
 
 class SERVER_EXPORT JackWaiterDriver : public JackTimedDriver
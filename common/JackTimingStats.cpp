@@ -0,0 +1,195 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#include "JackTimingStats.h"
+#include "JackGraphManager.h"
+#include "JackClientControl.h"
+#include "JackClientInterface.h"
+#include "JackAtomic.h"
+#include <string.h>
+#include <algorithm>
+
+#define TIMING_STATS_READ_RETRY 16
+
+namespace Jack
+{
+
+void JackClientTimingStats::WriteBegin()
+{
+    fWriteCounter++;
+    JACK_REL_FENCE();
+}
+
+void JackClientTimingStats::WriteEnd()
+{
+    JACK_REL_FENCE();
+    fWriteCounter++;
+}
+
+/*!
+\brief Copy a consistent state of the statistics, returns false if the writer kept changing them.
+*/
+bool JackClientTimingStats::Read(JackClientTimingStats* stats)
+{
+    for (int i = 0; i < TIMING_STATS_READ_RETRY; i++) {
+        UInt32 counter = fWriteCounter;
+        JACK_ACQ_FENCE();
+        if (counter & 1) {
+            continue;
+        }
+        memcpy(stats, this, sizeof(JackClientTimingStats));
+        JACK_ACQ_FENCE();
+        if (fWriteCounter == counter) {
+            stats->fWriteCounter = counter;
+            return true;
+        }
+    }
+    return false;
+}
+
+JackTimingStats::JackTimingStats():fNext(0), fClientEnd(0)
+{
+    static_assert((TIMING_STATS_WINDOW & (TIMING_STATS_WINDOW - 1)) == 0, "TIMING_STATS_WINDOW must be a power of two");
+    // Force memory page in
+    memset(fWakeLatency, 0, sizeof(fWakeLatency));
+    memset(fDuration, 0, sizeof(fDuration));
+    for (int i = 0; i < CLIENT_NUM; i++) {
+        fSamples[i] = 0;
+        fCycles[i] = 0;
+        fDeadlineMisses[i] = 0;
+        fLastSignaledAt[i] = 0;
+        fActive[i] = false;
+    }
+}
+
+static void ComputeStats(const UInt32* window, int count, float* mean, float* max, float* p99)
+{
+    UInt32 sorted[TIMING_STATS_WINDOW];
+    UInt64 sum = 0;
+    UInt32 max_value = 0;
+
+    for (int i = 0; i < count; i++) {
+        sorted[i] = window[i];
+        sum += window[i];
+        max_value = std::max(max_value, window[i]);
+    }
+
+    UInt32* nth = sorted + (count - 1) * 99 / 100;
+    std::nth_element(sorted, nth, sorted + count);
+    *mean = float(sum) / count;
+    *max = float(max_value);
+    *p99 = float(*nth);
+}
+
+void JackTimingStats::Publish(int refnum, JackClientTimingStats* stats)
+{
+    int count = std::min(fSamples[refnum], UInt32(TIMING_STATS_WINDOW));
+
+    stats->WriteBegin();
+    if (count > 0) {
+        ComputeStats(fWakeLatency[refnum], count, &stats->fWakeLatencyMean, &stats->fWakeLatencyMax, &stats->fWakeLatencyP99);
+        ComputeStats(fDuration[refnum], count, &stats->fDurationMean, &stats->fDurationMax, &stats->fDurationP99);
+    }
+    stats->fCycles = fCycles[refnum];
+    stats->fDeadlineMisses = fDeadlineMisses[refnum];
+    stats->WriteEnd();
+}
+
+/*!
+\brief Called by the server RT thread at each cycle begin, with the timing of the previous cycle.
+
+A client still triggered or running at the next cycle begin missed its deadline.
+Clients wake-up histograms are also fed here, and cleared when a client is activated.
+*/
+void JackTimingStats::Update(JackClientInterface** table,
+                             JackGraphManager* manager,
+                             int driver_num,
+                             int client_end,
+                             JackClientTimingStats* stats,
+                             JackWakeHistogram* wake)
+{
+    // Refnums released since the previous cycle are still visited once, to clear their statistics
+    int end = std::max(client_end, fClientEnd);
+    fClientEnd = client_end;
+
+    for (int i = driver_num; i < end; i++) {
+        JackClientInterface* client = table[i];
+        bool active = (client && client->GetClientControl()->fActive);
+
+        if (active != fActive[i]) {
+            fActive[i] = active;
+            fSamples[i] = 0;
+            fCycles[i] = 0;
+            fDeadlineMisses[i] = 0;
+            fLastSignaledAt[i] = 0;
+            wake[i].Clear();
+            stats[i].WriteBegin();
+            stats[i].Clear();
+            if (active) {
+                strcpy(stats[i].fName, client->GetClientControl()->fName);
+            } else {
+                stats[i].fName[0] = 0;
+            }
+            stats[i].WriteEnd();
+        }
+
+        if (!active) {
+            continue;
+        }
+
+        JackClientTiming* timing = manager->GetClientTiming(i);
+        switch (timing->fStatus) {
+
+            case Triggered:
+            case Running:
+                fDeadlineMisses[i]++;
+                break;
+
+            case Finished:
+                // Samples are taken once, the graph may not be triggered again when the previous cycle was late
+                if (timing->fSignaledAt != fLastSignaledAt[i] && timing->fAwakeAt >= timing->fSignaledAt && timing->fFinishedAt >= timing->fAwakeAt) {
+                    // Inputs mixed before the client was woken are not part of its wake latency
+                    jack_time_t signaled_at = (timing->fMixedAt > timing->fSignaledAt && timing->fMixedAt <= timing->fAwakeAt)
+                        ? timing->fMixedAt : timing->fSignaledAt;
+                    UInt32 index = fSamples[i]++ & (TIMING_STATS_WINDOW - 1);
+                    fWakeLatency[i][index] = UInt32(timing->fAwakeAt - signaled_at);
+                    fDuration[i][index] = UInt32(timing->fFinishedAt - timing->fAwakeAt);
+                    wake[i].Add(timing->fAwakeAt - signaled_at);
+                    fLastSignaledAt[i] = timing->fSignaledAt;
+                    fCycles[i]++;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Publish the next active client statistics, in round robin
+    for (int i = driver_num; i < client_end; i++) {
+        int refnum = fNext;
+        fNext = (fNext + 1 < client_end) ? fNext + 1 : driver_num;
+        if (fActive[refnum]) {
+            Publish(refnum, &stats[refnum]);
+            break;
+        }
+    }
+}
+
+} // end of namespace
@@ -0,0 +1,168 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#ifndef __JackTimingStats__
+#define __JackTimingStats__
+
+#include "types.h"
+#include "JackTypes.h"
+#include "JackConstants.h"
+
+namespace Jack
+{
+
+/* TIMING_STATS_WINDOW must be a power of two */
+#define TIMING_STATS_WINDOW 256
+#define WAKE_HISTOGRAM_BUCKETS 24
+
+/*!
+\brief Log-scale histogram of wake-up delays, in shared memory.
+
+Bucket 0 counts delays up to 1 usec, bucket i delays in (2^(i-1), 2^i] usecs, the last bucket all longer delays :
+bucket i upper bound is 2^i, as the OpenMetrics 'le' bound.
+Only written by the server RT thread, readers may see a count being incremented.
+*/
+
+PRE_PACKED_STRUCTURE
+struct SERVER_EXPORT JackWakeHistogram
+{
+    UInt32 fBuckets[WAKE_HISTOGRAM_BUCKETS];
+    UInt32 fCount;
+    UInt32 fMaxUsecs;
+
+    JackWakeHistogram()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        for (int i = 0; i < WAKE_HISTOGRAM_BUCKETS; i++) {
+            fBuckets[i] = 0;
+        }
+        fCount = 0;
+        fMaxUsecs = 0;
+    }
+
+    void Add(jack_time_t usecs)
+    {
+        UInt32 value = (usecs < 0xFFFFFFFF) ? UInt32(usecs) : 0xFFFFFFFF;
+        UInt32 rest = (value > 0) ? value - 1 : 0;
+        int bucket = 0;
+        while (bucket < WAKE_HISTOGRAM_BUCKETS - 1 && (rest >> bucket) != 0) {
+            bucket++;
+        }
+        fBuckets[bucket]++;
+        fCount++;
+        if (value > fMaxUsecs) {
+            fMaxUsecs = value;
+        }
+    }
+
+} POST_PACKED_STRUCTURE;
+
+/*!
+\brief Timing statistics of a client, in shared memory.
+
+Mean, max and p99 are computed on the last TIMING_STATS_WINDOW cycles the client was triggered in,
+cycles and deadline misses are counted since the client activation. Written by the server RT thread,
+readers retry while fWriteCounter is odd or changed during the copy.
+*/
+
+PRE_PACKED_STRUCTURE
+struct SERVER_EXPORT JackClientTimingStats
+{
+    alignas(UInt32) volatile UInt32 fWriteCounter;
+    float fWakeLatencyMean;
+    float fWakeLatencyMax;
+    float fWakeLatencyP99;
+    float fDurationMean;
+    float fDurationMax;
+    float fDurationP99;
+    UInt32 fCycles;
+    UInt32 fDeadlineMisses;
+    char fName[JACK_CLIENT_NAME_SIZE+4];  // Empty when the slot is not used, sized to keep the next slot aligned
+
+    JackClientTimingStats()
+    {
+        static_assert(sizeof(JackClientTimingStats) % sizeof(UInt32) == 0,
+                      "JackClientTimingStats must keep fWriteCounter aligned in arrays");
+        fWriteCounter = 0;
+        Clear();
+        fName[0] = 0;
+    }
+
+    void Clear()
+    {
+        fWakeLatencyMean = fWakeLatencyMax = fWakeLatencyP99 = 0.f;
+        fDurationMean = fDurationMax = fDurationP99 = 0.f;
+        fCycles = 0;
+        fDeadlineMisses = 0;
+    }
+
+    void WriteBegin();
+    void WriteEnd();
+    bool Read(JackClientTimingStats* stats);
+
+} POST_PACKED_STRUCTURE;
+
+class JackClientInterface;
+class JackGraphManager;
+
+/*!
+\brief Server side windows of the clients wake latency and duration, published in JackClientTimingStats.
+
+Only used by the server RT thread : clients activation and deactivation are detected at each cycle,
+samples are added for all clients, but the statistics of only one client are recomputed and published
+per cycle to bound the RT thread cost.
+*/
+
+class SERVER_EXPORT JackTimingStats
+{
+
+    private:
+
+        UInt32 fWakeLatency[CLIENT_NUM][TIMING_STATS_WINDOW];
+        UInt32 fDuration[CLIENT_NUM][TIMING_STATS_WINDOW];
+        UInt32 fSamples[CLIENT_NUM];
+        UInt32 fCycles[CLIENT_NUM];
+        UInt32 fDeadlineMisses[CLIENT_NUM];
+        jack_time_t fLastSignaledAt[CLIENT_NUM];
+        bool fActive[CLIENT_NUM];
+        int fNext;
+        int fClientEnd;
+
+        void Publish(int refnum, JackClientTimingStats* stats);
+
+    public:
+
+        JackTimingStats();
+
+        void Update(JackClientInterface** table,
+                    JackGraphManager* manager,
+                    int driver_num,
+                    int client_end,
+                    JackClientTimingStats* stats,
+                    JackWakeHistogram* wake);
+
+};
+
+} // end of namespace
+
+#endif
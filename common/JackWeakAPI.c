@@ -23,6 +23,8 @@
 #include <jack/session.h>
 #include <jack/thread.h>
 #include <jack/midiport.h>
+#include <jack/trace.h>
+#include <jack/statistics.h>
 #include <math.h>
 #ifndef WIN32
 #include <dlfcn.h>
@@ -200,6 +202,7 @@ DECL_FUNCTION_NULL(jack_port_t *, jack_port_register, (jack_client_t *client, co
               (client, port_name, port_type, flags, buffer_size));
 DECL_FUNCTION(int, jack_port_unregister, (jack_client_t *client, jack_port_t* port), (client, port));
 DECL_FUNCTION_NULL(void *, jack_port_get_buffer, (jack_port_t *port, jack_nframes_t nframes), (port, nframes));
+DECL_FUNCTION(int, jack_port_get_buffers, (jack_port_t **ports, void **buffers, unsigned int count, jack_nframes_t nframes), (ports, buffers, count, nframes));
 DECL_FUNCTION_NULL(const char*, jack_port_name, (const jack_port_t *port), (port));
 DECL_FUNCTION_NULL(const char*, jack_port_short_name, (const jack_port_t *port), (port));
 DECL_FUNCTION(int, jack_port_flags, (const jack_port_t *port), (port));
@@ -232,6 +235,8 @@ DECL_FUNCTION(int, jack_port_monitoring_input, (jack_port_t *port) ,(port));
 DECL_FUNCTION(int, jack_connect, (jack_client_t * client, const char *source_port, const char *destination_port), (client, source_port, destination_port));
 DECL_FUNCTION(int, jack_disconnect, (jack_client_t * client, const char *source_port, const char *destination_port), (client, source_port, destination_port));
 DECL_FUNCTION(int, jack_port_disconnect, (jack_client_t * client, jack_port_t * port), (client, port));
+DECL_FUNCTION(int, jack_set_connection_gain, (jack_client_t * client, const char *source_port, const char *destination_port, float gain), (client, source_port, destination_port, gain));
+DECL_FUNCTION(int, jack_get_connection_gain, (jack_client_t * client, const char *source_port, const char *destination_port, float *gain), (client, source_port, destination_port, gain));
 DECL_FUNCTION(int, jack_port_name_size,(),());
 DECL_FUNCTION(int, jack_port_type_size,(),());
 DECL_FUNCTION(size_t, jack_port_type_get_buffer_size, (jack_client_t *client, const char* port_type), (client, port_type));
@@ -258,6 +263,14 @@ DECL_VOID_FUNCTION(jack_set_info_function, (print_function fun), (fun));
 DECL_FUNCTION(float, jack_get_max_delayed_usecs, (jack_client_t *client), (client));
 DECL_FUNCTION(float, jack_get_xrun_delayed_usecs, (jack_client_t *client), (client));
 DECL_VOID_FUNCTION(jack_reset_max_delayed_usecs, (jack_client_t *client), (client));
+DECL_FUNCTION(int, jack_client_get_timing_stats, (jack_client_t *client, const char *client_name, jack_client_timing_stats_t *stats), (client, client_name, stats));
+DECL_FUNCTION(int, jack_get_driver_wake_histogram, (jack_client_t *client, jack_wake_histogram_t *histogram), (client, histogram));
+DECL_FUNCTION(int, jack_get_driver_early_wake_histogram, (jack_client_t *client, jack_wake_histogram_t *histogram), (client, histogram));
+DECL_FUNCTION(int, jack_client_get_wake_histogram, (jack_client_t *client, const char *client_name, jack_wake_histogram_t *histogram), (client, client_name, histogram));
+DECL_VOID_FUNCTION(jack_reset_wake_histograms, (jack_client_t *client), (client));
+
+DECL_FUNCTION(uint32_t, jack_trace_get_position, (jack_client_t *client), (client));
+DECL_FUNCTION(int, jack_trace_read, (jack_client_t *client, uint32_t *position, jack_trace_event_t *events, int count, uint32_t *lost), (client, position, events, count, lost));
 
 DECL_FUNCTION(int, jack_release_timebase, (jack_client_t *client), (client));
 DECL_FUNCTION(int, jack_set_sync_callback, (jack_client_t *client, JackSyncCallback sync_callback, void *arg), (client, sync_callback, arg));
@@ -288,6 +301,7 @@ DECL_FUNCTION(int, jack_drop_real_time_scheduling, (jack_native_thread_t thread)
 
 DECL_FUNCTION(int, jack_client_stop_thread, (jack_client_t* client, jack_native_thread_t thread), (client, thread));
 DECL_FUNCTION(int, jack_client_kill_thread, (jack_client_t* client, jack_native_thread_t thread), (client, thread));
+DECL_FUNCTION(int, jack_set_process_thread_affinity, (jack_client_t* client, const char* cpus), (client, cpus));
 #ifndef WIN32
 DECL_VOID_FUNCTION(jack_set_thread_creator, (jack_thread_creator_t jtc), (jtc));
 #endif
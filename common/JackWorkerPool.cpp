@@ -0,0 +1,338 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#include "JackWorkerPool.h"
+#include "JackEngineControl.h"
+#include "JackClient.h"
+#include "JackGlobals.h"
+#include "JackAtomic.h"
+#include "JackError.h"
+#include "JackTime.h"
+#include "JackNotification.h"
+
+#define WORKER_QUEUE_MASK (WORKER_QUEUE_SIZE - 1)
+
+namespace Jack
+{
+
+JackWorkerPool* JackWorkerPool::fInstance = NULL;
+
+// Set to the worker in each worker thread
+static jack_tls_key gWorkerKey;
+static bool gKeyWorkerInitialized = jack_tls_allocate_key(&gWorkerKey);
+
+bool JackWorker::Init()
+{
+    JackEngineControl* control = fPool->fEngineControl;
+
+    // Never wait for pending graph changes in RT context
+    if (!jack_tls_set(JackGlobals::fRealTimeThread, this)) {
+        jack_error("Failed to set thread realtime key");
+    }
+    if (!jack_tls_set(gWorkerKey, this)) {
+        jack_error("Failed to set worker key");
+    }
+
+    if (control->fRealTime) {
+        set_threaded_log_function();
+        if (control->fDeadlineRuntime > 0) {
+            fThread.SetDeadline(control->DeadlineRuntime(), control->fConstraint, control->fPeriod);
+        }
+        if (fThread.AcquireSelfRealTime(control->fClientPriority) < 0) {
+            jack_error("JackWorker::AcquireSelfRealTime error");
+        }
+    }
+    return true;
+}
+
+bool JackWorker::Execute()
+{
+    jack_int_t refnum;
+
+    if (!fPool->WaitTask(this, &refnum)) {
+        return false;
+    }
+
+    // Then run the successors kept for this worker, as long as there is one
+    while (refnum != EMPTY) {
+        fPool->Run(refnum);
+        // Published as running before it is no longer kept as the next one
+        refnum = fNext;
+        fRunning = refnum;
+        JACK_FULL_FENCE();
+        fNext = EMPTY;
+    }
+    return true;
+}
+
+JackWorkerPool::JackWorkerPool()
+    : fEngineControl(NULL), fWorkerCount(0), fHead(0), fTail(0), fIdleCount(0), fEndedCount(0), fRunning(false)
+{
+    static_assert((WORKER_QUEUE_SIZE & WORKER_QUEUE_MASK) == 0 && WORKER_QUEUE_SIZE >= CLIENT_NUM,
+                  "WORKER_QUEUE_SIZE must be a power of two, at least CLIENT_NUM");
+
+    for (int i = 0; i < CLIENT_NUM; i++) {
+        fClients[i] = NULL;
+        fEnded[i] = false;
+    }
+    for (int i = 0; i < WORKER_QUEUE_SIZE; i++) {
+        fQueue[i].fSequence = i;
+        fQueue[i].fRefNum = EMPTY;
+    }
+    for (int i = 0; i < WORKER_THREAD_MAX; i++) {
+        fWorkers[i].fPool = this;
+    }
+}
+
+JackWorkerPool::~JackWorkerPool()
+{
+    Close();
+}
+
+int JackWorkerPool::Open(JackEngineControl* control)
+{
+    fEngineControl = control;
+
+    if (control->fWorkerCount == 0) {
+        return 0;
+    }
+
+    if (!fSignal.Allocate("jack_worker_pool", control->fServerName, 0)) {
+        jack_error("Cannot allocate worker pool synchro");
+        return -1;
+    }
+
+    fRunning = true;
+    for (fWorkerCount = 0; fWorkerCount < control->fWorkerCount; fWorkerCount++) {
+        JackWorker* worker = &fWorkers[fWorkerCount];
+        if (control->fClientCPUs[0]) {
+            worker->fThread.SetAffinity(control->fClientCPUs);
+        }
+        if (worker->fThread.StartSync() < 0) {
+            jack_error("Cannot start worker thread %d", fWorkerCount);
+            Close();
+            return -1;
+        }
+    }
+
+    fInstance = this;
+    JackGlobals::fDispatchRefNum = DispatchRefNum;
+    jack_log("JackWorkerPool::Open workers = %ld", fWorkerCount);
+    return 0;
+}
+
+void JackWorkerPool::Close()
+{
+    if (!fRunning) {
+        return;
+    }
+
+    JackGlobals::fDispatchRefNum = NULL;
+    fInstance = NULL;
+
+    // Each stopping worker wakes the next one
+    fRunning = false;
+    fSignal.Signal();
+    for (int i = 0; i < fWorkerCount; i++) {
+        fWorkers[i].fThread.Stop();
+    }
+    fWorkerCount = 0;
+    fSignal.Destroy();
+}
+
+/*!
+\brief Run the cycles of an activated internal client on the pool.
+*/
+void JackWorkerPool::AddClient(int refnum)
+{
+    JackClient* client = JackGlobals::fClientTable[refnum];
+
+    // External clients are not in the server process table
+    if (fRunning && client && client->CanExecuteCycle()) {
+        jack_log("JackWorkerPool::AddClient ref = %ld", refnum);
+        fClients[refnum] = client;
+    }
+}
+
+/*!
+\brief Called once the client is out of the graph : wait for a worker possibly still returning from its last cycle.
+
+A worker publishes a client as running (or kept as its next one) before reading its slot : either it is seen here,
+or it reads the emptied slot and does not run the client.
+*/
+void JackWorkerPool::RemoveClient(int refnum)
+{
+    if (fClients[refnum] == NULL) {
+        return;
+    }
+
+    jack_log("JackWorkerPool::RemoveClient ref = %ld", refnum);
+    fClients[refnum] = NULL;
+    JACK_FULL_FENCE();
+
+    JackWorker* self = (JackWorker*)jack_tls_get(gWorkerKey);
+    for (int i = 0; i < fWorkerCount; i++) {
+        while (&fWorkers[i] != self && (fWorkers[i].fRunning == UInt32(refnum) || fWorkers[i].fNext == refnum)) {
+            JackSleep(100);
+        }
+    }
+}
+
+bool JackWorkerPool::DispatchRefNum(int refnum)
+{
+    JackWorkerPool* pool = fInstance;
+    return (pool) ? pool->Dispatch(refnum) : false;
+}
+
+/*!
+\brief Called by the thread making a client ready : returns false when the client has to be woken the usual way.
+*/
+bool JackWorkerPool::Dispatch(int refnum)
+{
+    if (fClients[refnum] == NULL) {
+        return false;
+    }
+
+    // The first successor made ready by a worker is run next by the same worker
+    JackWorker* worker = (JackWorker*)jack_tls_get(gWorkerKey);
+    if (worker && worker->fNext == EMPTY) {
+        worker->fNext = refnum;
+        return true;
+    }
+
+    if (!Push(refnum)) {
+        return false;
+    }
+    // Pairs with WaitTask : either the queued client is seen there, or the idle worker is seen here
+    JACK_FULL_FENCE();
+    if (fIdleCount > 0) {
+        fSignal.Signal();
+    }
+    return true;
+}
+
+/*!
+\brief Called by the driver thread each cycle : the server thread then deactivates the clients that ended their cycles.
+*/
+void JackWorkerPool::NotifyEnded(JackServerNotifyChannel* channel)
+{
+    if (fEndedCount == 0) {
+        return;
+    }
+    JACK_ACQ_FENCE();
+    for (int i = fEngineControl->fDriverNum; i < fEngineControl->fClientEnd; i++) {
+        if (fEnded[i]) {
+            fEnded[i] = false;
+            DEC_ATOMIC(&fEndedCount);
+            channel->Notify(i, kProcessEnded, 0);
+        }
+    }
+}
+
+bool JackWorkerPool::Push(jack_int_t refnum)
+{
+    for (;;) {
+        UInt32 pos = fTail;
+        JackWorkerTask* task = &fQueue[pos & WORKER_QUEUE_MASK];
+        SInt32 diff = SInt32(task->fSequence - pos);
+        if (diff == 0) {
+            if (CAS(pos, pos + 1, &fTail)) {
+                task->fRefNum = refnum;
+                JACK_REL_FENCE();
+                task->fSequence = pos + 1;
+                return true;
+            }
+        } else if (diff < 0) {
+            jack_error("JackWorkerPool::Push queue full ref = %ld", refnum);
+            return false;
+        }
+    }
+}
+
+bool JackWorkerPool::Pop(JackWorker* worker, jack_int_t* refnum)
+{
+    for (;;) {
+        UInt32 pos = fHead;
+        JackWorkerTask* task = &fQueue[pos & WORKER_QUEUE_MASK];
+        SInt32 diff = SInt32(task->fSequence - (pos + 1));
+        if (diff == 0) {
+            if (CAS(pos, pos + 1, &fHead)) {
+                JACK_ACQ_FENCE();
+                *refnum = task->fRefNum;
+                // Published as running before the queue no longer holds it
+                worker->fRunning = *refnum;
+                JACK_FULL_FENCE();
+                task->fSequence = pos + WORKER_QUEUE_SIZE;
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        }
+    }
+}
+
+/*!
+\brief Wait for a queued client, returns false when the pool is stopping.
+*/
+bool JackWorkerPool::WaitTask(JackWorker* worker, jack_int_t* refnum)
+{
+    for (;;) {
+        if (!fRunning) {
+            fSignal.Signal();
+            return false;
+        }
+        if (Pop(worker, refnum)) {
+            break;
+        }
+        INC_ATOMIC(&fIdleCount);
+        JACK_FULL_FENCE();
+        // Queued before we were counted idle : no wake-up to wait for
+        if (Pop(worker, refnum)) {
+            DEC_ATOMIC(&fIdleCount);
+            break;
+        }
+        if (fRunning) {
+            fSignal.Wait();
+        }
+        DEC_ATOMIC(&fIdleCount);
+    }
+
+    // The synchro only keeps one wake-up : pass it on while clients are still queued
+    if (fHead != fTail && fIdleCount > 0) {
+        fSignal.Signal();
+    }
+    return true;
+}
+
+void JackWorkerPool::Run(jack_int_t refnum)
+{
+    JackClient* client = fClients[refnum];
+    if (client) {
+        // Deactivating waits for the graph : asked to the server thread by NotifyEnded
+        if (client->ExecuteCycle() != 0) {
+            fEnded[refnum] = true;
+            INC_ATOMIC(&fEndedCount);
+        }
+    } else {
+        // Removed in the meantime
+        GetSynchroTable()[refnum].Signal();
+    }
+}
+
+} // end of namespace
@@ -0,0 +1,124 @@
+/*
+Copyright (C) 2026 agent
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#ifndef __JackWorkerPool__
+#define __JackWorkerPool__
+
+#include "JackConstants.h"
+#include "JackPlatformPlug.h"
+#include "JackTypes.h"
+
+namespace Jack
+{
+
+class JackClient;
+class JackWorkerPool;
+struct JackEngineControl;
+
+#define WORKER_QUEUE_SIZE 1024      // Power of two, above the max number of clients ready at the same time
+
+/*!
+\brief A worker thread of the pool.
+*/
+
+class JackWorker : public JackRunnableInterface
+{
+
+    friend class JackWorkerPool;
+
+    private:
+
+        JackWorkerPool* fPool;
+        JackThread fThread;
+        volatile jack_int_t fNext;      // Ready client kept by the worker for itself, EMPTY if none
+        volatile UInt32 fRunning;       // Client taken by the worker, EMPTY if none
+
+    public:
+
+        JackWorker(): fPool(NULL), fThread(this), fNext(EMPTY), fRunning(EMPTY)
+        {}
+
+        // JackRunnableInterface interface
+        bool Init();
+        bool Execute();
+
+};
+
+/*!
+\brief Server RT threads running internal clients cycles.
+
+When a thread of the server process makes an internal client ready, the client is queued to the pool instead of
+waking its own thread. A worker running a client keeps the first successor it makes ready and runs it next, without
+any wake-up at all; the other ones are queued, and only idle workers are woken. Internal clients keep their own
+thread, still woken when the last input of the cycle is an external client.
+*/
+
+class SERVER_EXPORT JackWorkerPool
+{
+
+    friend class JackWorker;
+
+    private:
+
+        struct JackWorkerTask {
+            volatile UInt32 fSequence;
+            jack_int_t fRefNum;
+        };
+
+        JackEngineControl* fEngineControl;
+        JackWorker fWorkers[WORKER_THREAD_MAX];
+        int fWorkerCount;
+        JackClient* volatile fClients[CLIENT_NUM];
+        JackWorkerTask fQueue[WORKER_QUEUE_SIZE];   // Bounded multi producers, multi consumers queue
+        volatile UInt32 fHead;
+        volatile UInt32 fTail;
+        volatile SInt32 fIdleCount;
+        volatile bool fEnded[CLIENT_NUM];           // Cycle returned a non-zero status, deactivation not asked yet
+        volatile SInt32 fEndedCount;
+        volatile bool fRunning;
+        JackSynchro fSignal;
+
+        static JackWorkerPool* fInstance;
+
+        static bool DispatchRefNum(int refnum);
+
+        bool Push(jack_int_t refnum);
+        bool Pop(JackWorker* worker, jack_int_t* refnum);
+        bool WaitTask(JackWorker* worker, jack_int_t* refnum);
+        void Run(jack_int_t refnum);
+
+    public:
+
+        JackWorkerPool();
+        ~JackWorkerPool();
+
+        int Open(JackEngineControl* control);
+        void Close();
+
+        void AddClient(int refnum);
+        void RemoveClient(int refnum);
+
+        bool Dispatch(int refnum);
+        void NotifyEnded(JackServerNotifyChannel* channel);
+
+};
+
+} // end of namespace
+
+#endif
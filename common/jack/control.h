@@ -16,6 +16,7 @@
 #include <jack/types.h>
 #include <jack/jslist.h>
 #include <jack/systemdeps.h>
+#include <jack/statistics.h>
 #if !defined(sun) && !defined(__sun__)
 #include <stdbool.h>
 #endif
@@ -292,6 +293,89 @@ bool
 jackctl_server_switch_master(jackctl_server_t * server,
                             jackctl_driver_t * driver);
 
+/**
+ * Call this function to get how client waits were satisfied when the
+ * "sync-spin" server parameter is enabled. Counters are summed over
+ * all currently opened clients.
+ *
+ * @param server server object handle
+ * @param spun number of waits satisfied while spinning
+ * @param slept number of waits that spun and then had to sleep
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_get_sync_spin_stats(jackctl_server_t * server,
+                            uint32_t * spun,
+                            uint32_t * slept);
+
+/**
+ * Call this function to get the timing statistics of an active client:
+ * wake latency and process duration over its last cycles, and the number
+ * of cycles it was still waiting or running at the next cycle begin.
+ *
+ * @param server server object handle
+ * @param client_name name of the client
+ * @param stats statistics to fill
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_get_client_timing_stats(jackctl_server_t * server,
+                            const char * client_name,
+                            jack_client_timing_stats_t * stats);
+
+/**
+ * Call this function to get the histogram of the driver late
+ * wake-ups, against the dates predicted from the previous cycles.
+ *
+ * @param server server object handle
+ * @param histogram histogram to fill
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_get_driver_wake_histogram(jackctl_server_t * server,
+                            jack_wake_histogram_t * histogram);
+
+/**
+ * Call this function to get the histogram of the driver early
+ * wake-ups, against the dates predicted from the previous cycles.
+ *
+ * @param server server object handle
+ * @param histogram histogram to fill
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_get_driver_early_wake_histogram(jackctl_server_t * server,
+                            jack_wake_histogram_t * histogram);
+
+/**
+ * Call this function to get the histogram of an active client wake-up
+ * delays, from the client being signaled to its thread waking up.
+ *
+ * @param server server object handle
+ * @param client_name name of the client
+ * @param histogram histogram to fill
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_get_client_wake_histogram(jackctl_server_t * server,
+                            const char * client_name,
+                            jack_wake_histogram_t * histogram);
+
+/**
+ * Call this function to clear the driver and clients wake-up
+ * histograms, done by the server at its next cycle.
+ *
+ * @param server server object handle
+ *
+ * @return success status: true - success, false - fail
+ */
+bool
+jackctl_server_reset_wake_histograms(jackctl_server_t * server);
 
 /**
  * Call this function to get name of driver.
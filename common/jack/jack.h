@@ -780,6 +780,20 @@ int jack_port_unregister (jack_client_t *client, jack_port_t *port) JACK_OPTIONA
  */
 void * jack_port_get_buffer (jack_port_t *port, jack_nframes_t) JACK_OPTIONAL_WEAK_EXPORT;
 
+/**
+ * Get the buffers of several ports at once, as jack_port_get_buffer
+ * would return them one by one. Within a process callback, the buffer
+ * of a port is only resolved once per cycle : an input connected to
+ * several outputs is not mixed again when asked a second time.
+ *
+ * @param ports the ports.
+ * @param buffers filled with the @a count buffers, NULL for an invalid port.
+ * @param count number of ports.
+ *
+ * @return 0 on success, otherwise a non-zero error code.
+ */
+int jack_port_get_buffers (jack_port_t **ports, void **buffers, unsigned int count, jack_nframes_t) JACK_OPTIONAL_WEAK_EXPORT;
+
 /**
  * @return the UUID of the jack_port_t
  *
@@ -1011,6 +1025,35 @@ int jack_disconnect (jack_client_t *client,
  */
 int jack_port_disconnect (jack_client_t *client, jack_port_t *port) JACK_OPTIONAL_WEAK_EXPORT;
 
+/**
+ * Set the gain applied to a connection between two audio ports.
+ *
+ * The destination port then becomes a summing bus: the server sums
+ * its connections, each one scaled by its gain (1.0 by default), in
+ * a single pass, even when there is only one connection. This avoids
+ * running a client whose only job is to mix its inputs. A gain
+ * change is ramped over the first cycle it is applied in.
+ *
+ * The gain is reset to 1.0 when the ports are disconnected.
+ *
+ * @return 0 on success, otherwise a non-zero error code
+ */
+int jack_set_connection_gain (jack_client_t *client,
+                              const char *source_port,
+                              const char *destination_port,
+                              float gain) JACK_OPTIONAL_WEAK_EXPORT;
+
+/**
+ * Get the gain of a connection between two ports, set by
+ * jack_set_connection_gain().
+ *
+ * @return 0 on success, otherwise a non-zero error code
+ */
+int jack_get_connection_gain (jack_client_t *client,
+                              const char *source_port,
+                              const char *destination_port,
+                              float *gain) JACK_OPTIONAL_WEAK_EXPORT;
+
 /**
  * @return the maximum number of characters in a full JACK port name
  * including the final NULL character.  This value is a constant.
@@ -55,6 +55,104 @@ float jack_get_xrun_delayed_usecs (jack_client_t *client);
  */
 void jack_reset_max_delayed_usecs (jack_client_t *client);
 
+/**
+ * Timing statistics of a client. Mean, max and 99th percentile values
+ * are in microseconds, computed on the last 256 cycles the client was
+ * run in, and refreshed by the server every few cycles.
+ */
+typedef struct {
+
+    /** time between the client being signaled and waking up */
+    float wake_latency_mean;
+    float wake_latency_max;
+    float wake_latency_p99;
+    /** time spent by the client in its process cycle */
+    float duration_mean;
+    float duration_max;
+    float duration_p99;
+    /** cycles the client finished since its activation */
+    uint32_t cycles;
+    /** cycles the client was still waiting or running at the next
+     * cycle begin since its activation */
+    uint32_t deadline_misses;
+
+} jack_client_timing_stats_t;
+
+/**
+ * Get the timing statistics of an active client, to find which client
+ * is responsible for an overloaded graph.
+ *
+ * @param client pointer to JACK client structure.
+ * @param client_name name of the client to get the statistics of.
+ * @param stats statistics to fill.
+ *
+ * @return 0 on success, -1 if the client is not active or the
+ * statistics could not be read.
+ */
+int jack_client_get_timing_stats (jack_client_t *client,
+                                  const char *client_name,
+                                  jack_client_timing_stats_t *stats);
+
+/**
+ * Number of buckets of a wake-up delay histogram.
+ */
+#define JACK_WAKE_HISTOGRAM_BUCKETS 24
+
+/**
+ * Log-scale histogram of wake-up delays. buckets[0] counts delays
+ * up to 1 microsecond, buckets[i] delays longer than 2^(i-1) and up
+ * to 2^i microseconds, and the last bucket all longer delays.
+ */
+typedef struct {
+
+    uint32_t buckets[JACK_WAKE_HISTOGRAM_BUCKETS];
+    /** total number of delays */
+    uint32_t count;
+    /** longest delay in microseconds */
+    uint32_t max_usecs;
+
+} jack_wake_histogram_t;
+
+/**
+ * Get the histogram of the driver late wake-ups: how long after the
+ * date predicted from the previous cycles each cycle began (e.g. ALSA
+ * poll return).
+ *
+ * @return 0 on success, -1 otherwise.
+ */
+int jack_get_driver_wake_histogram (jack_client_t *client,
+                                    jack_wake_histogram_t *histogram);
+
+/**
+ * Get the histogram of the driver early wake-ups: how long before the
+ * date predicted from the previous cycles each cycle began.
+ *
+ * @return 0 on success, -1 otherwise.
+ */
+int jack_get_driver_early_wake_histogram (jack_client_t *client,
+                                          jack_wake_histogram_t *histogram);
+
+/**
+ * Get the histogram of a client wake-up delays: the time between the
+ * client being signaled and its process thread waking up. It is
+ * cleared when the client is activated.
+ *
+ * @param client pointer to JACK client structure.
+ * @param client_name name of an active client.
+ * @param histogram histogram to fill.
+ *
+ * @return 0 on success, -1 if the client is not active.
+ */
+int jack_client_get_wake_histogram (jack_client_t *client,
+                                    const char *client_name,
+                                    jack_wake_histogram_t *histogram);
+
+/**
+ * Clear the driver and all clients wake-up histograms. The server
+ * clears them at its next cycle.
+ */
+void jack_reset_wake_histograms (jack_client_t *client);
+
 #ifdef __cplusplus
 }
 #endif
@@ -125,6 +125,22 @@ int jack_client_stop_thread(jack_client_t* client, jack_native_thread_t thread)
  */
  int jack_client_kill_thread(jack_client_t* client, jack_native_thread_t thread) JACK_OPTIONAL_WEAK_EXPORT;
 
+/**
+ * Pin the client process thread to a set of CPUs. The thread is
+ * created with this affinity when the client is activated, so this
+ * must be called before jack_activate().
+ *
+ * When not called, the JACK_CLIENT_CPUS environment variable is
+ * used, and otherwise the CPU suggested by the server (see the
+ * "client-cpus" server parameter), if any.
+ *
+ * @param client the JACK client.
+ * @param cpus CPU list like "2-3,6", or NULL to use the default.
+ *
+ * @returns 0, if successful; otherwise -1.
+ */
+int jack_set_process_thread_affinity(jack_client_t* client, const char* cpus) JACK_OPTIONAL_WEAK_EXPORT;
+
 #ifndef _WIN32
 
  typedef int (*jack_thread_creator_t)(pthread_t*,
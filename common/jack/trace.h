@@ -0,0 +1,131 @@
+/*
+   Copyright (C) 2026 agent
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as published by
+   the Free Software Foundation; either version 2.1 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+*/
+
+#ifndef __jack_trace_h__
+#define __jack_trace_h__
+
+#include <jack/types.h>
+#include <jack/weakmacros.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @file jack/trace.h
+ * @brief Live timing of the server cycles
+ *
+ * The server keeps the timing of its last cycles in a ring shared with
+ * its clients. For each cycle, one event describes the driver cycle and
+ * one event describes each client that was triggered in this cycle.
+ * Readers keep their own position in the ring, old events are overwritten
+ * by the server and are then reported as lost.
+ *
+ * When started with the "trace-analysis" parameter, the server also
+ * computes the critical path of each cycle: the chain of clients, each
+ * one waiting for the previous one to finish, that ends with the last
+ * client to finish. The slack of a client is the time it could have
+ * finished later without delaying the end of the cycle: shortening a
+ * client with some slack does not shorten the cycle. Without this
+ * parameter, the triggered_by, slack and critical fields are 0.
+ */
+
+/**
+ * @defgroup TraceFunctions Tracing the server cycles
+ * @{
+ */
+
+/**
+ * Client state at the end of a traced cycle.
+ */
+enum JackTraceStatus {
+    JackTraceNotTriggered = 0,
+    JackTraceTriggered = 1,
+    JackTraceRunning = 2,
+    JackTraceFinished = 3
+};
+
+/**
+ * Timing of a client, or of the driver, during a cycle. All dates are
+ * in microseconds, in the jack_get_time() time base.
+ */
+typedef struct {
+
+    /** cycle counter, the same for all the events of a cycle */
+    uint32_t cycle;
+    /** one of the JackTraceStatus values */
+    uint32_t status;
+    /** traced client, 0 for the driver cycle event */
+    jack_uuid_t client;
+    /** date the client was signaled, cycle begin date for the driver */
+    jack_time_t signaled;
+    /** date the client woke up, cycle begin date for the driver */
+    jack_time_t awake;
+    /** date the client finished, cycle end date for the driver */
+    jack_time_t finished;
+    /** period of the cycle in microseconds */
+    jack_time_t period_usecs;
+    /** connected client that finished last before this one woke up, 0 when
+     * only waiting for the driver */
+    jack_uuid_t triggered_by;
+    /** time in microseconds the client could have finished later without
+     * delaying the end of the cycle */
+    uint32_t slack;
+    /** position of the client on the critical path starting from 1, 0 when
+     * not on the critical path */
+    uint32_t critical;
+
+} jack_trace_event_t;
+
+/**
+ * @return the current position in the trace ring, to be given to the
+ * first jack_trace_read() call to only get the next cycles.
+ */
+uint32_t jack_trace_get_position (jack_client_t *client) JACK_OPTIONAL_WEAK_EXPORT;
+
+/**
+ * Read the events traced since a given position.
+ *
+ * This function does not block and can be called from the process
+ * callback.
+ *
+ * @param client pointer to JACK client structure.
+ * @param position position to read from, updated to the position of the
+ * next events to read.
+ * @param events array of at least count events.
+ * @param count maximum number of events to read.
+ * @param lost if not NULL, set to the number of events overwritten
+ * before they could be read.
+ *
+ * @return the number of events read, or -1 on error.
+ */
+int jack_trace_read (jack_client_t *client,
+                     uint32_t *position,
+                     jack_trace_event_t *events,
+                     int count,
+                     uint32_t *lost) JACK_OPTIONAL_WEAK_EXPORT;
+
+/*@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __jack_trace_h__ */
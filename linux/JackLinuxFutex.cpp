@@ -29,15 +29,41 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <sys/mman.h>
 #include <syscall.h>
 #include <linux/futex.h>
+#include <time.h>
+#include <unistd.h>
 
 #if !defined(SYS_futex) && defined(SYS_futex_time64)
 #define SYS_futex SYS_futex_time64
 #endif
 
+// Shortest spin worth doing (in usecs), also used as probe when spinning is not paying off
+#define JACK_FUTEX_SPIN_MIN 2
+// Number of polls between two clock reads while spinning
+#define JACK_FUTEX_SPIN_POLLS 32
+
+// Spin timing does not depend on the engine clock source, which may not be initialized yet
+static inline jack_time_t SpinClock()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return jack_time_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void CPURelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH) && (__ARM_ARCH >= 7))
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
 namespace Jack
 {
 
-JackLinuxFutex::JackLinuxFutex() : JackSynchro(), fSharedMem(-1), fFutex(NULL), fPrivate(false)
+JackLinuxFutex::JackLinuxFutex() : JackSynchro(), fSharedMem(-1), fFutex(NULL), fPrivate(false), fSpinEstimate(0)
 {
     const char* promiscuous = getenv("JACK_PROMISCUOUS_SERVER");
     fPromiscuous = (promiscuous != NULL);
@@ -81,6 +107,83 @@ bool JackLinuxFutex::SignalAll()
     return Signal();
 }
 
+// Poll the futex word for at most the calibrated spin time
+bool JackLinuxFutex::SpinWait(jack_time_t begin)
+{
+    if (fSpinEstimate <= 0 || fSpinEstimate > fFutex->spinUsecs) {
+        fSpinEstimate = fFutex->spinUsecs;
+    }
+
+    const jack_time_t end = begin + fSpinEstimate;
+
+    do {
+        for (int i = 0; i < JACK_FUTEX_SPIN_POLLS; i++) {
+            if (__atomic_load_n(&fFutex->futex, __ATOMIC_RELAXED) == 1
+                && __sync_bool_compare_and_swap(&fFutex->futex, 1, 0)) {
+                fFutex->spinHits++;
+                CalibrateSpin(SpinClock() - begin);
+                return true;
+            }
+            CPURelax();
+        }
+    } while (SpinClock() < end);
+
+    fFutex->spinMisses++;
+    return false;
+}
+
+// Adapt the spin time to how long upstream clients actually took to wake us
+void JackLinuxFutex::CalibrateSpin(jack_time_t delay)
+{
+    const int max_spin = fFutex->spinUsecs;
+
+    if (delay < jack_time_t(max_spin)) {
+        // Aim above the observed delay so that a similar wake is caught while spinning
+        int target = int(delay) * 2 + JACK_FUTEX_SPIN_MIN;
+        if (target > max_spin) {
+            target = max_spin;
+        }
+        fSpinEstimate = (fSpinEstimate + target) / 2;
+    } else {
+        // Upstream is slower than the spin budget : back off, but keep probing
+        fSpinEstimate /= 2;
+    }
+
+    if (fSpinEstimate < JACK_FUTEX_SPIN_MIN) {
+        fSpinEstimate = JACK_FUTEX_SPIN_MIN;
+    }
+}
+
+void JackLinuxFutex::SetSpin(int usec)
+{
+    if (!fFutex) {
+        jack_error("JackLinuxFutex::SetSpin name = %s already deallocated!!", fName);
+        return;
+    }
+
+    // Spinning only burns the CPU the signaling side needs on uniprocessor hosts
+    if (usec > 0 && sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        jack_log("JackLinuxFutex::SetSpin name = %s spinning disabled on single CPU host", fName);
+        usec = 0;
+    }
+
+    jack_log("JackLinuxFutex::SetSpin name = %s usec = %d", fName, usec);
+    fFutex->spinUsecs = (usec > 0) ? usec : 0;
+    fSpinEstimate = fFutex->spinUsecs;
+}
+
+bool JackLinuxFutex::GetSpinStats(unsigned int* spun, unsigned int* slept)
+{
+    if (!fFutex) {
+        *spun = *slept = 0;
+        return false;
+    }
+
+    *spun = fFutex->spinHits;
+    *slept = fFutex->spinMisses;
+    return true;
+}
+
 bool JackLinuxFutex::Wait()
 {
     if (!fFutex) {
@@ -96,10 +199,22 @@ bool JackLinuxFutex::Wait()
 
     const int wait_mode = fFutex->internal ? FUTEX_WAIT_PRIVATE : FUTEX_WAIT;
 
+    if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0))
+        return true;
+
+    const bool spin = (fFutex->spinUsecs > 0);
+    const jack_time_t begin = (spin) ? SpinClock() : 0;
+
+    if (spin && SpinWait(begin))
+        return true;
+
     for (;;)
     {
-        if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0))
+        if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0)) {
+            if (spin)
+                CalibrateSpin(SpinClock() - begin);
             return true;
+        }
 
         if (::syscall(SYS_futex, fFutex, wait_mode, 0, NULL, NULL, 0) != 0)
             if (errno != EAGAIN && errno != EINTR)
@@ -123,6 +238,21 @@ bool JackLinuxFutex::TimedWait(long usec)
         fFutex->internal = !fFutex->internal;
     }
 
+    if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0))
+        return true;
+
+    const bool spin = (fFutex->spinUsecs > 0);
+    const jack_time_t begin = (spin) ? SpinClock() : 0;
+
+    if (spin) {
+        if (SpinWait(begin))
+            return true;
+        // Time spent spinning is part of the timeout
+        usec -= long(SpinClock() - begin);
+        if (usec < 0)
+            usec = 0;
+    }
+
     const uint secs  =  usec / 1000000;
     const int  nsecs = (usec % 1000000) * 1000;
 
@@ -131,8 +261,11 @@ bool JackLinuxFutex::TimedWait(long usec)
 
     for (;;)
     {
-        if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0))
+        if (__sync_bool_compare_and_swap(&fFutex->futex, 1, 0)) {
+            if (spin)
+                CalibrateSpin(SpinClock() - begin);
             return true;
+        }
 
         if (::syscall(SYS_futex, fFutex, wait_mode, 0, &timeout, NULL, 0) != 0)
             if (errno != EAGAIN && errno != EINTR)
@@ -180,7 +313,11 @@ bool JackLinuxFutex::Allocate(const char* name, const char* server_name, int val
     futex->wasInternal = internal;
     futex->needsChange = false;
     futex->externalCount = 0;
+    futex->spinUsecs = 0;
+    futex->spinHits = 0;
+    futex->spinMisses = 0;
     fFutex = futex;
+    fSpinEstimate = 0;
     return true;
 }
 
@@ -222,6 +359,7 @@ bool JackLinuxFutex::Connect(const char* name, const char* server_name)
     }
 
     fFutex = futex;
+    fSpinEstimate = futex->spinUsecs;
     return true;
 }
 
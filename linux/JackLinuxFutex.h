@@ -23,7 +23,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 
 #include "JackSynchro.h"
 #include "JackCompilerDeps.h"
+#include "types.h"
 #include <stddef.h>
+#include <stdint.h>
 
 namespace Jack
 {
@@ -36,6 +38,10 @@ namespace Jack
 
  Adds a new 'MakePrivate' function that makes the sync happen in the local process only,
  making it even faster for internal clients.
+
+ Waiters can optionally poll the futex word for a bounded time before sleeping (see SetSpin).
+ The spin time is calibrated from the observed wake delays, that is how long upstream clients
+ usually take to signal us, so that small periods avoid the futex sleep/wake latency.
 */
 
 class SERVER_EXPORT JackLinuxFutex : public detail::JackSynchro
@@ -48,6 +54,9 @@ class SERVER_EXPORT JackLinuxFutex : public detail::JackSynchro
             bool wasInternal;  // initial internal state, only changes in allocate
             bool needsChange;  // change state on next wait call
             int externalCount; // how many external clients have connected
+            int spinUsecs;     // max spin time before sleeping, 0 means no spinning
+            uint32_t spinHits;   // waits satisfied while spinning
+            uint32_t spinMisses; // waits that went to sleep after spinning
         };
 
         int fSharedMem;
@@ -55,11 +64,15 @@ class SERVER_EXPORT JackLinuxFutex : public detail::JackSynchro
         bool fPrivate;
         bool fPromiscuous;
         int fPromiscuousGid;
+        int fSpinEstimate;     // calibrated spin time in usecs, local to the waiting process
 
     protected:
 
         void BuildName(const char* name, const char* server_name, char* res, int size);
 
+        bool SpinWait(jack_time_t begin);
+        void CalibrateSpin(jack_time_t delay);
+
     public:
 
         JackLinuxFutex();
@@ -77,6 +90,9 @@ class SERVER_EXPORT JackLinuxFutex : public detail::JackSynchro
         void Destroy();
 
         void MakePrivate(bool priv);
+
+        void SetSpin(int usec);
+        bool GetSpinStats(unsigned int* spun, unsigned int* slept);
 };
 
 } // end of namespace
@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -161,6 +162,30 @@ SERVER_EXPORT void JackSleep(long usec)
 	usleep(usec);
 }
 
+/* Sleep until a GetMicroSeconds date. The clock source may be the raw
+   monotonic clock or the HPET, which clock_nanosleep does not support :
+   the date is converted to CLOCK_MONOTONIC just before sleeping, an
+   absolute deadline is then not delayed by a preemption. */
+SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec)
+{
+	jack_time_t now_usec = GetMicroSeconds();
+
+	if (date_usec <= now_usec) {
+		return;
+	}
+
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec deadline;
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	uint64_t nsec = (uint64_t)deadline.tv_nsec + (date_usec - now_usec) * 1000;
+	deadline.tv_sec += nsec / 1000000000;
+	deadline.tv_nsec = nsec % 1000000000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {}
+#else
+	usleep(date_usec - now_usec);
+#endif
+}
+
 SERVER_EXPORT void InitTime()
 {
 	/* nothing to do on a generic system - we use the system clock */
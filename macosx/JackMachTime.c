@@ -47,6 +47,11 @@ SERVER_EXPORT jack_time_t GetMicroSeconds(void)
     return (jack_time_t) (mach_absolute_time() * __jack_time_ratio);
 }
 
+SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec)
+{
+    mach_wait_until((uint64_t) (date_usec / __jack_time_ratio));
+}
+
 void SetClockSource(jack_timer_type_t source)
 {}
 
@@ -22,8 +22,13 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "JackError.h"
 #include "JackTime.h"
 #include "JackGlobals.h"
+#include "JackTools.h"
 #include <string.h> // for memset
 #include <unistd.h> // for _POSIX_PRIORITY_SCHEDULING check
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <stdint.h>
+#endif
 
 //#define JACK_SCHED_POLICY SCHED_RR
 #define JACK_SCHED_POLICY SCHED_FIFO
@@ -32,6 +37,27 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 # define SCHED_RESET_ON_FORK 0x40000000
 #endif
 
+#ifdef __linux__
+#ifndef SCHED_DEADLINE
+# define SCHED_DEADLINE 6
+#endif
+#ifndef SCHED_FLAG_RESET_ON_FORK
+# define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+
+// Not exposed by all C libraries
+struct jack_sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+#endif
+
 namespace Jack
 {
 
@@ -47,6 +73,9 @@ void* JackPosixThread::ThreadHandler(void* arg)
 
     // Signal creation thread when started with StartSync
     jack_log("JackPosixThread::ThreadHandler : start");
+#ifdef __linux__
+    obj->fTID = syscall(SYS_gettid);
+#endif
     obj->fStatus = kIniting;
 
     // Call Init method
@@ -73,7 +102,7 @@ int JackPosixThread::Start()
     fStatus = kStarting;
 
     // Check if the thread was correctly started
-    if (StartImp(&fThread, fPriority, fRealTime, ThreadHandler, this) < 0) {
+    if (StartImp(&fThread, fPriority, fRealTime, ThreadHandler, this, fCPUs) < 0) {
         fStatus = kIdle;
         return -1;
     } else {
@@ -85,7 +114,7 @@ int JackPosixThread::StartSync()
 {
     fStatus = kStarting;
 
-    if (StartImp(&fThread, fPriority, fRealTime, ThreadHandler, this) < 0) {
+    if (StartImp(&fThread, fPriority, fRealTime, ThreadHandler, this, fCPUs) < 0) {
         fStatus = kIdle;
         return -1;
     } else {
@@ -97,7 +126,22 @@ int JackPosixThread::StartSync()
     }
 }
 
+void JackPosixThread::SetAffinity(const char* cpus)
+{
+    if (cpus) {
+        strncpy(fCPUs, cpus, sizeof(fCPUs));
+        fCPUs[sizeof(fCPUs) - 1] = 0;
+    } else {
+        fCPUs[0] = 0;
+    }
+}
+
 int JackPosixThread::StartImp(jack_native_thread_t* thread, int priority, int realtime, void*(*start_routine)(void*), void* arg)
+{
+    return StartImp(thread, priority, realtime, start_routine, arg, NULL);
+}
+
+int JackPosixThread::StartImp(jack_native_thread_t* thread, int priority, int realtime, void*(*start_routine)(void*), void* arg, const char* cpus)
 {
     pthread_attr_t attributes;
     struct sched_param rt_param;
@@ -148,7 +192,38 @@ int JackPosixThread::StartImp(jack_native_thread_t* thread, int priority, int re
         return -1;
     }
 
+    // Pin the thread at creation time, so that it never runs outside of its CPUs
+    if (cpus && cpus[0]) {
+    #ifdef __linux__
+        int cpu_list[JACK_CPU_LIST_MAX];
+        int count = JackTools::ParseCPUList(cpus, cpu_list, JACK_CPU_LIST_MAX);
+        if (count > 0) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            for (int i = 0; i < count; i++) {
+                if (cpu_list[i] < CPU_SETSIZE) {
+                    CPU_SET(cpu_list[i], &cpu_set);
+                }
+            }
+            jack_log("JackPosixThread::StartImp : affinity = %s", cpus);
+            if ((res = pthread_attr_setaffinity_np(&attributes, sizeof(cpu_set), &cpu_set))) {
+                jack_error("Cannot set thread affinity to %s res = %d", cpus, res);
+            }
+        } else {
+            jack_error("Cannot parse thread affinity CPU list %s", cpus);
+        }
+    #else
+        jack_log("JackPosixThread::StartImp : thread affinity not supported, ignoring %s", cpus);
+    #endif
+    }
+
     if ((res = JackGlobals::fJackThreadCreator(thread, &attributes, start_routine, arg))) {
+        pthread_attr_destroy(&attributes);
+        if (cpus && cpus[0]) {
+            // Typically a CPU that is not online, do not prevent the thread from running
+            jack_error("Cannot create thread pinned to CPUs %s res = %d, trying without affinity", cpus, res);
+            return StartImp(thread, priority, realtime, start_routine, arg, NULL);
+        }
         jack_error("Cannot create thread res = %d", res);
         return -1;
     }
@@ -211,13 +286,31 @@ int JackPosixThread::StopImp(jack_native_thread_t thread)
     }
 }
 
+void JackPosixThread::SetDeadline(UInt64 runtime, UInt64 deadline, UInt64 period)
+{
+    fDeadlineRuntime = runtime;
+    fDeadlineDeadline = deadline;
+    fDeadlinePeriod = period;
+}
+
 int JackPosixThread::AcquireRealTime()
 {
-    return (fThread != (jack_native_thread_t)NULL) ? AcquireRealTimeImp(fThread, fPriority) : -1;
+    if (fThread == (jack_native_thread_t)NULL) {
+        return -1;
+    }
+    if (fDeadlinePeriod > 0 && fTID > 0 && AcquireDeadlineImp(fTID, fDeadlineRuntime, fDeadlineDeadline, fDeadlinePeriod) == 0) {
+        return 0;
+    }
+    return AcquireRealTimeImp(fThread, fPriority);
 }
 
 int JackPosixThread::AcquireSelfRealTime()
 {
+#ifdef __linux__
+    if (fDeadlinePeriod > 0 && AcquireDeadlineImp(syscall(SYS_gettid), fDeadlineRuntime, fDeadlineDeadline, fDeadlinePeriod) == 0) {
+        return 0;
+    }
+#endif
     return AcquireRealTimeImp(pthread_self(), fPriority);
 }
 
@@ -256,6 +349,40 @@ int JackPosixThread::AcquireRealTimeImp(jack_native_thread_t thread, int priorit
     return -1;
 }
 
+/*!
+\brief Use SCHED_DEADLINE, returns -1 when the kernel refuses it so that the caller can fall back to JACK_SCHED_POLICY.
+
+The kernel refuses it when the bandwidth admission control fails, when the thread affinity is
+restricted to a subset of its root domain, or without privileges.
+*/
+int JackPosixThread::AcquireDeadlineImp(int tid, UInt64 runtime, UInt64 deadline, UInt64 period)
+{
+#ifdef __linux__
+    struct jack_sched_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_flags = SCHED_FLAG_RESET_ON_FORK;
+    attr.sched_runtime = runtime;
+    attr.sched_deadline = (deadline > 0 && deadline < period) ? deadline : period;
+    attr.sched_period = period;
+
+    if (attr.sched_runtime > attr.sched_deadline) {
+        attr.sched_runtime = attr.sched_deadline;
+    }
+
+    jack_log("JackPosixThread::AcquireDeadlineImp runtime = %lld deadline = %lld period = %lld",
+             (long long)attr.sched_runtime, (long long)attr.sched_deadline, (long long)attr.sched_period);
+
+    if (syscall(SYS_sched_setattr, tid, &attr, 0) == 0) {
+        return 0;
+    }
+
+    jack_error("Cannot use SCHED_DEADLINE (%d: %s), using real-time scheduling instead", errno, strerror(errno));
+#endif
+    return -1;
+}
+
 int JackPosixThread::DropRealTime()
 {
     return (fThread != (jack_native_thread_t)NULL) ? DropRealTimeImp(fThread) : -1;
@@ -41,16 +41,31 @@ class SERVER_EXPORT JackPosixThread : public detail::JackThreadInterface
     protected:
 
         jack_native_thread_t fThread;
+        char fCPUs[JACK_CPU_LIST_SIZE];     // CPU list the thread is pinned to when started, empty for no pinning
+        UInt64 fDeadlineRuntime;            // SCHED_DEADLINE parameters in nanoseconds, 0 period to use JACK_SCHED_POLICY
+        UInt64 fDeadlineDeadline;
+        UInt64 fDeadlinePeriod;
+        int fTID;                           // Kernel thread id, needed by SCHED_DEADLINE
+
         static void* ThreadHandler(void* arg);
 
     public:
 
         JackPosixThread(JackRunnableInterface* runnable, bool real_time, int priority, int cancellation)
-                : JackThreadInterface(runnable, priority, real_time, cancellation), fThread((jack_native_thread_t)NULL)
-        {}
+                : JackThreadInterface(runnable, priority, real_time, cancellation), fThread((jack_native_thread_t)NULL),
+                fDeadlineRuntime(0), fDeadlineDeadline(0), fDeadlinePeriod(0), fTID(0)
+        {
+            fCPUs[0] = 0;
+        }
         JackPosixThread(JackRunnableInterface* runnable, int cancellation = PTHREAD_CANCEL_ASYNCHRONOUS)
-                : JackThreadInterface(runnable, 0, false, cancellation), fThread((jack_native_thread_t)NULL)
-        {}
+                : JackThreadInterface(runnable, 0, false, cancellation), fThread((jack_native_thread_t)NULL),
+                fDeadlineRuntime(0), fDeadlineDeadline(0), fDeadlinePeriod(0), fTID(0)
+        {
+            fCPUs[0] = 0;
+        }
+
+        void SetAffinity(const char* cpus);
+        void SetDeadline(UInt64 runtime, UInt64 deadline, UInt64 period);
 
         int Start();
         int StartSync();
@@ -75,8 +90,10 @@ class SERVER_EXPORT JackPosixThread : public detail::JackThreadInterface
         {
             return JackPosixThread::AcquireRealTimeImp(thread, priority);
         }
+        static int AcquireDeadlineImp(int tid, UInt64 runtime, UInt64 deadline, UInt64 period);
         static int DropRealTimeImp(jack_native_thread_t thread);
         static int StartImp(jack_native_thread_t* thread, int priority, int realtime, void*(*start_routine)(void*), void* arg);
+        static int StartImp(jack_native_thread_t* thread, int priority, int realtime, void*(*start_routine)(void*), void* arg, const char* cpus);
         static int StopImp(jack_native_thread_t thread);
         static int KillImp(jack_native_thread_t thread);
 };
@@ -47,6 +47,15 @@ SERVER_EXPORT void JackSleep(long usec)
 	usleep(usec);
 }
 
+SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec)
+{
+	/* GetMicroSeconds uses CLOCK_MONOTONIC */
+	struct timespec deadline;
+	deadline.tv_sec = date_usec / 1000000;
+	deadline.tv_nsec = (date_usec % 1000000) * 1000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {}
+}
+
 SERVER_EXPORT void InitTime()
 {
 	/* nothing to do on a generic system - we use the system clock */
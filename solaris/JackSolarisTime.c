@@ -39,6 +39,14 @@ SERVER_EXPORT jack_time_t GetMicroSeconds(void)
     return (jack_time_t)(gethrtime() / 1000);
 }
 
+SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec)
+{
+    jack_time_t now_usec = GetMicroSeconds();
+    if (date_usec > now_usec) {
+        usleep(date_usec - now_usec);
+    }
+}
+
 void SetClockSource(jack_timer_type_t source)
 {}
 
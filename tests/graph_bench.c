@@ -0,0 +1,783 @@
+/*
+    Copyright (C) 2026 agent
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/** @file graph_bench.c
+ *
+ * @brief Synthetic graph stress benchmark.
+ *
+ * N clients with M ports each are connected in a chain, a fan-out/fan-in,
+ * a random DAG or not at all, each one copying its inputs to its outputs
+ * and burning a calibrated amount of CPU. The cycles are then read from
+ * the server trace ring to report the achieved cycles per second, the
+ * per-cycle overhead beyond the DSP work of the critical path, and the
+ * clients wake latency percentiles.
+ *
+ * Built against the server library (SERVER_SIDE), jack_graph_bench starts
+ * its own server with the dummy driver, and runs the clients either in the
+ * server process or in a jack_graph_bench_client external process. Built
+ * against the client library, jack_graph_bench_client runs the benchmark
+ * against an already running server.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <jack/jack.h>
+#include <jack/trace.h>
+#include <jack/uuid.h>
+#ifdef SERVER_SIDE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <jack/control.h>
+#endif
+
+#define MAX_CLIENTS 256
+#define MAX_PORTS 64
+#define MAX_SAMPLES (1 << 20)
+#define TRACE_CHUNK 1024
+#define SETTLE_USECS 1000000
+
+#ifdef SERVER_SIDE
+#define BENCH_SERVER_NAME "graph_bench"
+#define BENCH_CLIENT_PROGRAM "jack_graph_bench_client"
+#endif
+
+enum {
+    TOPOLOGY_PARALLEL,
+    TOPOLOGY_CHAIN,
+    TOPOLOGY_FAN,
+    TOPOLOGY_RANDOM
+};
+
+static const char* topology_names[] = { "parallel", "chain", "fan", "random" };
+
+typedef struct {
+    jack_client_t* client;
+    jack_port_t* inputs[MAX_PORTS];
+    jack_port_t* outputs[MAX_PORTS];
+    unsigned long loops;
+} bench_client_t;
+
+typedef struct {
+    unsigned int* values;
+    unsigned int count;
+    unsigned long long sum;
+} samples_t;
+
+static bench_client_t clients[MAX_CLIENTS];
+static int client_count = 8;
+static int port_count = 1;
+static int topology = TOPOLOGY_CHAIN;
+static int work_usecs = 10;
+static int duration = 5;
+static int edge_percent = 25;
+static unsigned int seed = 1;
+static int freewheel = 0;
+static const char* server_name = NULL;
+
+static double loops_per_usec = 0.;
+static volatile float work_sink;
+
+static samples_t overhead_samples;
+static samples_t wake_samples;
+
+static void usage()
+{
+    fprintf(stderr, "\n"
+#ifdef SERVER_SIDE
+                    "usage: jack_graph_bench \n"
+#else
+                    "usage: jack_graph_bench_client \n"
+#endif
+                    "              [ --clients OR -n client_count (default 8) ]\n"
+                    "              [ --ports OR -p ports_per_client (default 1) ]\n"
+                    "              [ --topology OR -t parallel|chain|fan|random (default chain) ]\n"
+                    "              [ --work OR -w usecs_per_client (default 10) ]\n"
+                    "              [ --edges OR -e percent (random topology edge probability, default 25) ]\n"
+                    "              [ --seed OR -S seed (random topology, default 1) ]\n"
+                    "              [ --duration OR -d seconds (default 5) ]\n"
+                    "              [ --freewheel OR -f (run the cycles as fast as possible) ]\n"
+#ifdef SERVER_SIDE
+                    "              [ --external OR -x (run the clients in a " BENCH_CLIENT_PROGRAM " process) ]\n"
+                    "              [ --period OR -P frames (dummy driver buffer size, default 256) ]\n"
+                    "              [ --freewheel-period OR -F frames (buffer size in freewheel mode) ]\n"
+                    "              [ --pipeline OR -L stages (pipelined graph execution, default 1) ]\n"
+                    "              [ --wake-fanout OR -W clients (wake clients as a tree from this fan-out, default 0 = never) ]\n"
+                    "              [ --workers OR -T threads (run internal clients on a server worker pool, default 0 = none) ]\n"
+                    "              [ --server-mix OR -M (mix multi-connected inputs before waking their client) ]\n"
+                    "              [ --rate OR -r rate (dummy driver sample rate, default 48000) ]\n"
+                    "              [ --sync OR -y (synchronous server mode) ]\n"
+                    "              [ --no-realtime OR -N ]\n"
+#else
+                    "              [ --server OR -s server_name ]\n"
+#endif
+    );
+}
+
+static double now_usecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000. + ts.tv_nsec / 1000.;
+}
+
+static void busy_loop(unsigned long loops)
+{
+    float value = 0.f;
+    unsigned long i;
+
+    for (i = 0; i < loops; i++) {
+        value = value * 0.5f + 1.f;
+    }
+    work_sink = value;
+}
+
+/* Best of several runs, long enough to hide the clock resolution */
+static void calibrate()
+{
+    unsigned long loops = 1000;
+    double elapsed;
+    int i;
+
+    do {
+        loops *= 2;
+        double begin = now_usecs();
+        busy_loop(loops);
+        elapsed = now_usecs() - begin;
+    } while (elapsed < 5000.);
+
+    for (i = 0; i < 5; i++) {
+        double begin = now_usecs();
+        busy_loop(loops);
+        elapsed = now_usecs() - begin;
+        if (loops / elapsed > loops_per_usec) {
+            loops_per_usec = loops / elapsed;
+        }
+    }
+}
+
+static int process(jack_nframes_t nframes, void* arg)
+{
+    bench_client_t* bench = (bench_client_t*)arg;
+    int i;
+
+    for (i = 0; i < port_count; i++) {
+        memcpy(jack_port_get_buffer(bench->outputs[i], nframes),
+               jack_port_get_buffer(bench->inputs[i], nframes),
+               nframes * sizeof(jack_default_audio_sample_t));
+    }
+    busy_loop(bench->loops);
+    return 0;
+}
+
+static int open_clients()
+{
+    jack_options_t options = (server_name) ? (JackNoStartServer | JackServerName) : JackNoStartServer;
+    jack_status_t status;
+    char name[64];
+    int i, j;
+
+    for (i = 0; i < client_count; i++) {
+        bench_client_t* bench = &clients[i];
+        snprintf(name, sizeof(name), "bench_%03d", i);
+        bench->client = jack_client_open(name, options, &status, server_name);
+        if (bench->client == NULL) {
+            fprintf(stderr, "jack_client_open(%s) failed, status = 0x%2.0x\n", name, status);
+            return -1;
+        }
+        for (j = 0; j < port_count; j++) {
+            snprintf(name, sizeof(name), "in_%d", j);
+            bench->inputs[j] = jack_port_register(bench->client, name, JACK_DEFAULT_AUDIO_TYPE, JackPortIsInput, 0);
+            snprintf(name, sizeof(name), "out_%d", j);
+            bench->outputs[j] = jack_port_register(bench->client, name, JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
+            if (bench->inputs[j] == NULL || bench->outputs[j] == NULL) {
+                fprintf(stderr, "cannot register the ports of %s\n", jack_get_client_name(bench->client));
+                return -1;
+            }
+        }
+        bench->loops = (unsigned long)(work_usecs * loops_per_usec);
+        jack_set_process_callback(bench->client, process, bench);
+        if (jack_activate(bench->client) != 0) {
+            fprintf(stderr, "cannot activate %s\n", jack_get_client_name(bench->client));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void close_clients()
+{
+    int i;
+
+    for (i = 0; i < client_count; i++) {
+        if (clients[i].client) {
+            jack_deactivate(clients[i].client);
+            jack_client_close(clients[i].client);
+            clients[i].client = NULL;
+        }
+    }
+}
+
+static int connect_clients(jack_client_t* control, int src, int dst)
+{
+    int i;
+
+    for (i = 0; i < port_count; i++) {
+        if (jack_connect(control, jack_port_name(clients[src].outputs[i]), jack_port_name(clients[dst].inputs[i])) != 0) {
+            fprintf(stderr, "cannot connect %s to %s\n", jack_port_name(clients[src].outputs[i]), jack_port_name(clients[dst].inputs[i]));
+            return -1;
+        }
+    }
+    return 1;
+}
+
+/* Returns the number of client to client edges, or -1 on error */
+static int connect_topology(jack_client_t* control)
+{
+    int edges = 0;
+    int i, j, res;
+
+    switch (topology) {
+
+        case TOPOLOGY_CHAIN:
+            for (i = 0; i + 1 < client_count; i++) {
+                if ((res = connect_clients(control, i, i + 1)) < 0) {
+                    return -1;
+                }
+                edges += res;
+            }
+            break;
+
+        case TOPOLOGY_FAN:
+            // First client to all the middle ones, all the middle ones to the last client
+            for (i = 1; i + 1 < client_count; i++) {
+                if ((res = connect_clients(control, 0, i)) < 0 || (res = connect_clients(control, i, client_count - 1)) < 0) {
+                    return -1;
+                }
+                edges += 2 * res;
+            }
+            break;
+
+        case TOPOLOGY_RANDOM:
+            // Edges only go from lower to higher indexes, hence no feedback loop
+            srand(seed);
+            for (i = 0; i < client_count; i++) {
+                for (j = i + 1; j < client_count; j++) {
+                    if (rand() % 100 < edge_percent) {
+                        if ((res = connect_clients(control, i, j)) < 0) {
+                            return -1;
+                        }
+                        edges += res;
+                    }
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return edges;
+}
+
+static void add_sample(samples_t* samples, unsigned int value)
+{
+    samples->sum += value;
+    if (samples->count < MAX_SAMPLES) {
+        samples->values[samples->count++] = value;
+    }
+}
+
+static int compare_values(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*)a;
+    unsigned int y = *(const unsigned int*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_percentiles(const char* name, samples_t* samples)
+{
+    if (samples->count == 0) {
+        printf("%-14s : no sample\n", name);
+        return;
+    }
+    qsort(samples->values, samples->count, sizeof(unsigned int), compare_values);
+    printf("%-14s : mean %.1f  p50 %u  p90 %u  p99 %u  p99.9 %u  max %u usec (%u samples)\n",
+           name,
+           (double)samples->sum / samples->count,
+           samples->values[samples->count / 2],
+           samples->values[(unsigned long long)samples->count * 90 / 100],
+           samples->values[(unsigned long long)samples->count * 99 / 100],
+           samples->values[(unsigned long long)samples->count * 999 / 1000],
+           samples->values[samples->count - 1],
+           samples->count);
+}
+
+/* Events of one cycle : the driver cycle event, then the clients of the cycle */
+typedef struct {
+    int started;
+    int valid;
+    int finished;
+    jack_time_t begin;
+    jack_time_t end;
+    jack_time_t work;
+} cycle_t;
+
+typedef struct {
+    cycle_t cycle;
+    uint32_t first_cycle;
+    uint32_t last_cycle;
+    jack_time_t first_date;
+    jack_time_t last_date;
+    unsigned long complete_cycles;
+    unsigned long long work_sum;
+    unsigned long long lost;
+    jack_nframes_t buffer_size;
+    jack_nframes_t sample_rate;
+} bench_result_t;
+
+static void end_cycle(bench_result_t* result)
+{
+    cycle_t* cycle = &result->cycle;
+
+    // Cycles where a client was late or events were lost are only counted in the rate
+    if (cycle->started && cycle->valid && cycle->finished == client_count && cycle->end >= cycle->begin + cycle->work) {
+        add_sample(&overhead_samples, (unsigned int)(cycle->end - cycle->begin - cycle->work));
+        result->work_sum += cycle->work;
+        result->complete_cycles++;
+    }
+    memset(cycle, 0, sizeof(cycle_t));
+}
+
+static void add_event(bench_result_t* result, const jack_trace_event_t* event)
+{
+    cycle_t* cycle = &result->cycle;
+
+    if (jack_uuid_empty(event->client)) {
+        end_cycle(result);
+        if (result->first_date == 0) {
+            result->first_cycle = event->cycle;
+            result->first_date = event->signaled;
+        }
+        result->last_cycle = event->cycle;
+        result->last_date = event->signaled;
+        cycle->started = 1;
+        cycle->valid = 1;
+        cycle->begin = event->signaled;
+    } else if (cycle->started && event->status == JackTraceFinished) {
+        cycle->finished++;
+        if (event->finished > cycle->end) {
+            cycle->end = event->finished;
+        }
+        if (event->critical > 0) {
+            cycle->work += event->finished - event->awake;
+        }
+        add_sample(&wake_samples, (event->awake > event->signaled) ? (unsigned int)(event->awake - event->signaled) : 0);
+    }
+}
+
+static void measure(jack_client_t* control, bench_result_t* result)
+{
+    jack_trace_event_t events[TRACE_CHUNK];
+    uint32_t position = jack_trace_get_position(control);
+    double end = now_usecs() + duration * 1000000.;
+    uint32_t lost;
+    int count, i;
+
+    memset(result, 0, sizeof(bench_result_t));
+    result->buffer_size = jack_get_buffer_size(control);
+    result->sample_rate = jack_get_sample_rate(control);
+
+    while (now_usecs() < end) {
+        usleep(1000);
+        while ((count = jack_trace_read(control, &position, events, TRACE_CHUNK, &lost)) > 0 || lost > 0) {
+            if (lost > 0) {
+                result->lost += lost;
+                result->cycle.valid = 0;
+            }
+            for (i = 0; i < count; i++) {
+                add_event(result, &events[i]);
+            }
+            if (count < TRACE_CHUNK) {
+                break;
+            }
+        }
+    }
+    end_cycle(result);
+}
+
+static void print_result(bench_result_t* result, int edges, const char* mode)
+{
+    double seconds = (result->last_date - result->first_date) / 1000000.;
+
+    printf("topology       : %s, %d clients, %d ports each, %d edges, %d usec of work per client\n",
+           topology_names[topology], client_count, port_count, edges, work_usecs);
+    printf("mode           : %s%s, buffer size %u, sample rate %u\n",
+           mode, (freewheel) ? ", freewheel" : "", result->buffer_size, result->sample_rate);
+    if (seconds > 0.) {
+        double rate = (result->last_cycle - result->first_cycle) / seconds;
+        printf("cycles         : %.1f cycles/s over %.2f s (%u cycles)\n",
+               rate, seconds, result->last_cycle - result->first_cycle + 1);
+        printf("throughput     : %.2f x real time\n", rate * result->buffer_size / result->sample_rate);
+    }
+    printf("complete       : %lu cycles, %.1f usec of DSP work on the critical path per cycle\n",
+           result->complete_cycles, (result->complete_cycles > 0) ? (double)result->work_sum / result->complete_cycles : 0.);
+    print_percentiles("overhead", &overhead_samples);
+    print_percentiles("wake latency", &wake_samples);
+    if (result->lost > 0) {
+        printf("lost events    : %llu (the trace ring was not read fast enough)\n", result->lost);
+    }
+}
+
+static int run_bench(const char* mode)
+{
+    jack_options_t options = (server_name) ? (JackNoStartServer | JackServerName) : JackNoStartServer;
+    jack_status_t status;
+    jack_client_t* control;
+    bench_result_t result;
+    int edges, res = 1;
+
+    overhead_samples.values = (unsigned int*)malloc(MAX_SAMPLES * sizeof(unsigned int));
+    wake_samples.values = (unsigned int*)malloc(MAX_SAMPLES * sizeof(unsigned int));
+    if (overhead_samples.values == NULL || wake_samples.values == NULL) {
+        fprintf(stderr, "cannot allocate the samples\n");
+        return 1;
+    }
+
+    control = jack_client_open("bench_control", options, &status, server_name);
+    if (control == NULL) {
+        fprintf(stderr, "jack_client_open() failed, status = 0x%2.0x\n", status);
+        return 1;
+    }
+
+    calibrate();
+
+    if (open_clients() < 0 || (edges = connect_topology(control)) < 0) {
+        goto error;
+    }
+    if (freewheel && jack_set_freewheel(control, 1) != 0) {
+        fprintf(stderr, "cannot start freewheeling\n");
+        goto error;
+    }
+
+    usleep(SETTLE_USECS);
+    measure(control, &result);
+
+    if (freewheel) {
+        jack_set_freewheel(control, 0);
+    }
+    print_result(&result, edges, mode);
+    res = 0;
+
+error:
+    close_clients();
+    jack_client_close(control);
+    free(overhead_samples.values);
+    free(wake_samples.values);
+    return res;
+}
+
+#ifdef SERVER_SIDE
+
+static jackctl_parameter_t* find_parameter(const JSList* parameters, const char* name)
+{
+    for (; parameters; parameters = jack_slist_next(parameters)) {
+        if (strcmp(jackctl_parameter_get_name((jackctl_parameter_t*)parameters->data), name) == 0) {
+            return (jackctl_parameter_t*)parameters->data;
+        }
+    }
+    return NULL;
+}
+
+static void set_parameter(const JSList* parameters, const char* name, union jackctl_parameter_value* value)
+{
+    jackctl_parameter_t* parameter = find_parameter(parameters, name);
+    if (parameter) {
+        jackctl_parameter_set_value(parameter, value);
+    }
+}
+
+static jackctl_driver_t* find_driver(jackctl_server_t* server, const char* name)
+{
+    const JSList* drivers;
+
+    for (drivers = jackctl_server_get_drivers_list(server); drivers; drivers = jack_slist_next(drivers)) {
+        if (strcmp(jackctl_driver_get_name((jackctl_driver_t*)drivers->data), name) == 0) {
+            return (jackctl_driver_t*)drivers->data;
+        }
+    }
+    return NULL;
+}
+
+/* The same benchmark in a client library process, the external clients are all in this process */
+static int run_external(const char* argv0)
+{
+    char program[1024];
+    char clients_arg[16], ports_arg[16], work_arg[16], edges_arg[16], seed_arg[16], duration_arg[16];
+    const char* args[24];
+    const char* slash = strrchr(argv0, '/');
+    int status, n = 0;
+    pid_t pid;
+
+    if (slash) {
+        snprintf(program, sizeof(program), "%.*s/%s", (int)(slash - argv0), argv0, BENCH_CLIENT_PROGRAM);
+    } else {
+        snprintf(program, sizeof(program), "%s", BENCH_CLIENT_PROGRAM);
+    }
+
+    snprintf(clients_arg, sizeof(clients_arg), "%d", client_count);
+    snprintf(ports_arg, sizeof(ports_arg), "%d", port_count);
+    snprintf(work_arg, sizeof(work_arg), "%d", work_usecs);
+    snprintf(edges_arg, sizeof(edges_arg), "%d", edge_percent);
+    snprintf(seed_arg, sizeof(seed_arg), "%u", seed);
+    snprintf(duration_arg, sizeof(duration_arg), "%d", duration);
+
+    args[n++] = program;
+    args[n++] = "-s";
+    args[n++] = server_name;
+    args[n++] = "-n";
+    args[n++] = clients_arg;
+    args[n++] = "-p";
+    args[n++] = ports_arg;
+    args[n++] = "-t";
+    args[n++] = topology_names[topology];
+    args[n++] = "-w";
+    args[n++] = work_arg;
+    args[n++] = "-e";
+    args[n++] = edges_arg;
+    args[n++] = "-S";
+    args[n++] = seed_arg;
+    args[n++] = "-d";
+    args[n++] = duration_arg;
+    if (freewheel) {
+        args[n++] = "-f";
+    }
+    args[n] = NULL;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0) {
+        execvp(program, (char* const*)args);
+        fprintf(stderr, "cannot run %s\n", program);
+        _exit(1);
+    }
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+        return 1;
+    }
+    return WEXITSTATUS(status);
+}
+
+#endif
+
+int main(int argc, char *argv[])
+{
+    int opt, i, res;
+#ifdef SERVER_SIDE
+    int external = 0;
+    unsigned int period = 256;
+    unsigned int freewheel_period = 0;
+    unsigned int pipeline_stages = 1;
+    unsigned int wake_fanout = 0;
+    unsigned int workers = 0;
+    int server_mix = 0;
+    unsigned int rate = 48000;
+    int sync = 0;
+    int realtime = 1;
+    jackctl_server_t* server;
+    jackctl_driver_t* driver;
+    union jackctl_parameter_value value;
+    const char *options_string = "n:p:t:w:e:S:d:fxP:F:L:W:T:Mr:yNh";
+#else
+    const char *options_string = "n:p:t:w:e:S:d:fs:h";
+#endif
+    struct option long_options[] = {
+        {"clients", 1, 0, 'n'},
+        {"ports", 1, 0, 'p'},
+        {"topology", 1, 0, 't'},
+        {"work", 1, 0, 'w'},
+        {"edges", 1, 0, 'e'},
+        {"seed", 1, 0, 'S'},
+        {"duration", 1, 0, 'd'},
+        {"freewheel", 0, 0, 'f'},
+#ifdef SERVER_SIDE
+        {"external", 0, 0, 'x'},
+        {"period", 1, 0, 'P'},
+        {"freewheel-period", 1, 0, 'F'},
+        {"pipeline", 1, 0, 'L'},
+        {"wake-fanout", 1, 0, 'W'},
+        {"workers", 1, 0, 'T'},
+        {"server-mix", 0, 0, 'M'},
+        {"rate", 1, 0, 'r'},
+        {"sync", 0, 0, 'y'},
+        {"no-realtime", 0, 0, 'N'},
+#else
+        {"server", 1, 0, 's'},
+#endif
+        {"help", 0, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, options_string, long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'n':
+                client_count = atoi(optarg);
+                break;
+            case 'p':
+                port_count = atoi(optarg);
+                break;
+            case 't':
+                topology = -1;
+                for (i = 0; i < (int)(sizeof(topology_names) / sizeof(topology_names[0])); i++) {
+                    if (strcmp(optarg, topology_names[i]) == 0) {
+                        topology = i;
+                    }
+                }
+                if (topology < 0) {
+                    fprintf(stderr, "unknown topology %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'w':
+                work_usecs = atoi(optarg);
+                break;
+            case 'e':
+                edge_percent = atoi(optarg);
+                break;
+            case 'S':
+                seed = (unsigned int)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                duration = atoi(optarg);
+                break;
+            case 'f':
+                freewheel = 1;
+                break;
+#ifdef SERVER_SIDE
+            case 'x':
+                external = 1;
+                break;
+            case 'P':
+                period = (unsigned int)atoi(optarg);
+                break;
+            case 'F':
+                freewheel_period = (unsigned int)atoi(optarg);
+                break;
+            case 'L':
+                pipeline_stages = (unsigned int)atoi(optarg);
+                break;
+            case 'W':
+                wake_fanout = (unsigned int)atoi(optarg);
+                break;
+            case 'T':
+                workers = (unsigned int)atoi(optarg);
+                break;
+            case 'M':
+                server_mix = 1;
+                break;
+            case 'r':
+                rate = (unsigned int)atoi(optarg);
+                break;
+            case 'y':
+                sync = 1;
+                break;
+            case 'N':
+                realtime = 0;
+                break;
+#else
+            case 's':
+                server_name = optarg;
+                break;
+#endif
+            default:
+                usage();
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (client_count < 1 || client_count > MAX_CLIENTS || port_count < 1 || port_count > MAX_PORTS
+        || work_usecs < 0 || duration < 1 || (topology == TOPOLOGY_FAN && client_count < 3)) {
+        usage();
+        return 1;
+    }
+
+#ifdef SERVER_SIDE
+    server_name = BENCH_SERVER_NAME;
+    server = jackctl_server_create(NULL, NULL);
+    if (server == NULL) {
+        fprintf(stderr, "cannot create the server\n");
+        return 1;
+    }
+    strcpy(value.str, server_name);
+    set_parameter(jackctl_server_get_parameters(server), "name", &value);
+    value.b = realtime;
+    set_parameter(jackctl_server_get_parameters(server), "realtime", &value);
+    value.b = sync;
+    set_parameter(jackctl_server_get_parameters(server), "sync", &value);
+    value.ui = freewheel_period;
+    set_parameter(jackctl_server_get_parameters(server), "freewheel-buffer-size", &value);
+    value.ui = pipeline_stages;
+    set_parameter(jackctl_server_get_parameters(server), "pipeline-stages", &value);
+    value.ui = wake_fanout;
+    set_parameter(jackctl_server_get_parameters(server), "wake-fanout", &value);
+    value.ui = workers;
+    set_parameter(jackctl_server_get_parameters(server), "internal-workers", &value);
+    value.b = server_mix;
+    set_parameter(jackctl_server_get_parameters(server), "server-mix", &value);
+
+    driver = find_driver(server, "dummy");
+    if (driver == NULL) {
+        fprintf(stderr, "dummy driver not found\n");
+        jackctl_server_destroy(server);
+        return 1;
+    }
+    value.ui = period;
+    set_parameter(jackctl_driver_get_parameters(driver), "period", &value);
+    value.ui = rate;
+    set_parameter(jackctl_driver_get_parameters(driver), "rate", &value);
+
+    if (!jackctl_server_open(server, driver)) {
+        fprintf(stderr, "cannot open the server\n");
+        jackctl_server_destroy(server);
+        return 1;
+    }
+    if (!jackctl_server_start(server)) {
+        fprintf(stderr, "cannot start the server\n");
+        jackctl_server_close(server);
+        jackctl_server_destroy(server);
+        return 1;
+    }
+
+    res = (external) ? run_external(argv[0]) : run_bench("internal clients");
+
+    jackctl_server_stop(server);
+    jackctl_server_close(server);
+    jackctl_server_destroy(server);
+#else
+    res = run_bench("external clients");
+#endif
+
+    return res;
+}
@@ -0,0 +1,345 @@
+/*
+	Copyright (C) 2026 agent
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/*
+	Inter process synchronization benchmark.
+
+	A "server" process and a forked "client" process ping-pong through two
+	synchronization primitives, the same way the engine and a client do.
+	For each backend, scheduling policy and pinning combination it reports:
+
+	- the wake latency distribution (time between Signal in one process and
+	  Wait returning in the other), measured with the waiter already asleep,
+	- the back-to-back ping-pong throughput in round trips per second.
+*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <algorithm>
+
+#include "JackLinuxFutex.h"
+#include "JackPosixSemaphore.h"
+#include "JackFifo.h"
+
+#define SERVER "synchro_bench"
+#define PING "ping"
+#define PONG "pong"
+
+#define WARMUP 1000
+#define MAX_ITER 10000000
+
+using namespace Jack;
+
+struct BenchShared
+{
+    volatile unsigned long long fSentAt;
+    volatile int fReady;
+    unsigned long long fClientLatency[1];   // really sized to the iteration count
+};
+
+struct BenchConfig
+{
+    int fIterations;
+    int fGapUsecs;
+    int fPriority;
+    int fServerCPU;
+    int fClientCPU;
+    int fSpinUsecs;
+};
+
+static unsigned long long NowNsecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void Gap(int usecs)
+{
+    if (usecs > 0) {
+        struct timespec ts = { usecs / 1000000, (usecs % 1000000) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static bool SetupScheduling(bool rt, int priority, int cpu)
+{
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            printf("cannot pin to CPU %d : %s\n", cpu, strerror(errno));
+            return false;
+        }
+    } else {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            CPU_SET(i, &set);
+        }
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = (rt) ? priority : 0;
+    if (sched_setscheduler(0, (rt) ? SCHED_FIFO : SCHED_OTHER, &param) != 0) {
+        return false;
+    }
+    return true;
+}
+
+static void PrintPercentiles(const char* label, unsigned long long* samples, int count)
+{
+    std::sort(samples, samples + count);
+    printf("    %-12s p50 %8.2f  p99 %8.2f  p99.9 %8.2f  max %8.2f usec\n",
+           label,
+           samples[(count - 1) * 50 / 100] / 1000.,
+           samples[(count - 1) * 99 / 100] / 1000.,
+           samples[(long long)(count - 1) * 999 / 1000] / 1000.,
+           samples[count - 1] / 1000.);
+}
+
+template <typename sync_type>
+static void ClientLoop(BenchShared* shared, const BenchConfig& config, bool rt)
+{
+    sync_type ping, pong;
+
+    // Scheduling failures are reported by the server side
+    SetupScheduling(rt, config.fPriority, config.fClientCPU);
+
+    if (!ping.Connect(PING, SERVER) || !pong.Connect(PONG, SERVER)) {
+        printf("client cannot connect synchro\n");
+        _exit(1);
+    }
+    shared->fReady = 1;
+
+    // Latency phase : the server leaves a gap so that we are asleep when signaled
+    for (int i = 0; i < WARMUP + config.fIterations; i++) {
+        ping.Wait();
+        unsigned long long now = NowNsecs();
+        if (i >= WARMUP) {
+            shared->fClientLatency[i - WARMUP] = now - shared->fSentAt;
+        }
+        Gap(config.fGapUsecs);
+        shared->fSentAt = NowNsecs();
+        pong.Signal();
+    }
+
+    // Throughput phase
+    for (int i = 0; i < config.fIterations; i++) {
+        ping.Wait();
+        pong.Signal();
+    }
+
+    ping.Disconnect();
+    pong.Disconnect();
+    _exit(0);
+}
+
+template <typename sync_type>
+static void RunBench(const char* backend, const BenchConfig& config, bool rt, bool pinned)
+{
+    printf("%s, %s, %s\n", backend, (rt) ? "SCHED_FIFO" : "SCHED_OTHER", (pinned) ? "pinned" : "unpinned");
+
+    size_t size = sizeof(BenchShared) + sizeof(unsigned long long) * config.fIterations;
+    BenchShared* shared = (BenchShared*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        printf("    cannot allocate shared memory : %s\n", strerror(errno));
+        return;
+    }
+    unsigned long long* server_latency = new unsigned long long[config.fIterations];
+    sync_type ping, pong;
+    pid_t pid;
+    unsigned long long begin, end;
+
+    if (!ping.Allocate(PING, SERVER, 0) || !pong.Allocate(PONG, SERVER, 0)) {
+        printf("    cannot allocate synchro\n");
+        goto cleanup;
+    }
+    ping.SetSpin(config.fSpinUsecs);
+    pong.SetSpin(config.fSpinUsecs);
+
+    if (!SetupScheduling(rt, config.fPriority, (pinned) ? config.fServerCPU : -1)) {
+        printf("    skipped : cannot set scheduling (%s)\n", strerror(errno));
+        goto cleanup;
+    }
+
+    shared->fReady = 0;
+    if ((pid = fork()) == 0) {
+        ClientLoop<sync_type>(shared, config, rt);
+    } else if (pid < 0) {
+        printf("    cannot fork : %s\n", strerror(errno));
+        goto cleanup;
+    }
+
+    while (!shared->fReady) {
+        usleep(1000);
+    }
+
+    for (int i = 0; i < WARMUP + config.fIterations; i++) {
+        Gap(config.fGapUsecs);
+        shared->fSentAt = NowNsecs();
+        ping.Signal();
+        pong.Wait();
+        unsigned long long now = NowNsecs();
+        if (i >= WARMUP) {
+            server_latency[i - WARMUP] = now - shared->fSentAt;
+        }
+    }
+
+    begin = NowNsecs();
+    for (int i = 0; i < config.fIterations; i++) {
+        ping.Signal();
+        pong.Wait();
+    }
+    end = NowNsecs();
+
+    waitpid(pid, NULL, 0);
+
+    PrintPercentiles("client wake", shared->fClientLatency, config.fIterations);
+    PrintPercentiles("server wake", server_latency, config.fIterations);
+    printf("    ping-pong    %.0f round trips/s (%.2f usec per round trip)\n",
+           config.fIterations * 1e9 / (end - begin),
+           (end - begin) / 1000. / config.fIterations);
+
+cleanup:
+    ping.Destroy();
+    pong.Destroy();
+    delete [] server_latency;
+    munmap(shared, size);
+    SetupScheduling(false, 0, -1);
+}
+
+template <typename sync_type>
+static void RunMatrix(const char* backend, const BenchConfig& config, int policy, int pinning)
+{
+    for (int rt = 0; rt < 2; rt++) {
+        if (policy >= 0 && policy != rt) {
+            continue;
+        }
+        for (int pinned = 0; pinned < 2; pinned++) {
+            if (pinning >= 0 && pinning != pinned) {
+                continue;
+            }
+            RunBench<sync_type>(backend, config, rt, pinned);
+        }
+    }
+}
+
+static void Usage()
+{
+    printf("usage: jack_synchro_bench [options]\n");
+    printf("  -b, --backend <futex|fifo|sem|all>   synchronization backend (default all)\n");
+    printf("  -n, --iterations <n>                 samples per run (default 100000)\n");
+    printf("  -g, --gap <usec>                     sleep before each signal in the latency phase (default 100)\n");
+    printf("  -r, --realtime <0|1>                 only SCHED_OTHER (0) or SCHED_FIFO (1), default both\n");
+    printf("  -P, --priority <prio>                SCHED_FIFO priority (default 70)\n");
+    printf("  -p, --pin <0|1>                      only unpinned (0) or pinned (1), default both\n");
+    printf("  -c, --cpus <server,client>           CPUs used when pinned (default 0,1)\n");
+    printf("  -s, --spin <usec>                    futex spin before sleeping (default 0)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char* backend = "all";
+    int policy = -1;
+    int pinning = -1;
+    BenchConfig config = { 100000, 100, 70, 0, 1, 0 };
+
+    const char* options = "b:n:g:r:P:p:c:s:h";
+    struct option long_options[] = {
+        {"backend", 1, 0, 'b'},
+        {"iterations", 1, 0, 'n'},
+        {"gap", 1, 0, 'g'},
+        {"realtime", 1, 0, 'r'},
+        {"priority", 1, 0, 'P'},
+        {"pin", 1, 0, 'p'},
+        {"cpus", 1, 0, 'c'},
+        {"spin", 1, 0, 's'},
+        {"help", 0, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    int opt, option_index;
+
+    while ((opt = getopt_long(argc, argv, options, long_options, &option_index)) != EOF) {
+        switch (opt) {
+            case 'b':
+                backend = optarg;
+                break;
+            case 'n':
+                config.fIterations = atoi(optarg);
+                break;
+            case 'g':
+                config.fGapUsecs = atoi(optarg);
+                break;
+            case 'r':
+                policy = atoi(optarg);
+                break;
+            case 'P':
+                config.fPriority = atoi(optarg);
+                break;
+            case 'p':
+                pinning = atoi(optarg);
+                break;
+            case 'c':
+                if (sscanf(optarg, "%d,%d", &config.fServerCPU, &config.fClientCPU) != 2) {
+                    Usage();
+                    return 1;
+                }
+                break;
+            case 's':
+                config.fSpinUsecs = atoi(optarg);
+                break;
+            default:
+                Usage();
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (config.fIterations <= 0 || config.fIterations > MAX_ITER) {
+        printf("iterations must be between 1 and %d\n", MAX_ITER);
+        return 1;
+    }
+
+    printf("Synchronization primitives benchmark : %d samples per run\n", config.fIterations);
+
+    if (strcmp(backend, "all") == 0 || strcmp(backend, "futex") == 0) {
+        RunMatrix<JackLinuxFutex>("futex", config, policy, pinning);
+    }
+    if (strcmp(backend, "all") == 0 || strcmp(backend, "fifo") == 0) {
+        RunMatrix<JackFifo>("fifo", config, policy, pinning);
+    }
+    if (strcmp(backend, "all") == 0 || strcmp(backend, "sem") == 0) {
+        RunMatrix<JackPosixSemaphore>("posix semaphore", config, policy, pinning);
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+/*
+    Copyright (C) 2026 agent
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/** @file trace.c
+ *
+ * @brief Print the server cycles timing live, and export it in the Chrome
+ * trace event JSON format understood by Perfetto and chrome://tracing.
+ *
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <getopt.h>
+#include <jack/jack.h>
+#include <jack/uuid.h>
+#include <jack/trace.h>
+
+#define READ_EVENTS 1024
+#define MAX_TRACED_CLIENTS 256
+#define TRACED_NAME_SIZE 256
+
+typedef struct {
+    jack_uuid_t uuid;
+    char name[TRACED_NAME_SIZE];
+    unsigned long cycles;
+    unsigned long critical_cycles;
+    unsigned long long slack_sum;
+} traced_client_t;
+
+static jack_client_t* client = NULL;
+static traced_client_t clients[MAX_TRACED_CLIENTS];
+static int client_count = 0;
+static FILE* json = NULL;
+static int json_events = 0;
+static jack_time_t json_base = 0;
+static volatile int running = 1;
+static int critical_path[MAX_TRACED_CLIENTS];
+static int critical_length = 0;
+
+static const char* status_names[] = { "not triggered", "triggered", "running", "finished" };
+
+static void signal_handler(int sig)
+{
+    running = 0;
+}
+
+static void usage()
+{
+    fprintf(stderr, "\n"
+                    "usage: jack_trace \n"
+                    "              [ --server OR -s server_name ]\n"
+                    "              [ --time OR -t time_to_trace (in seconds, default until interrupted) ]\n"
+                    "              [ --json OR -j file (write a Chrome/Perfetto trace JSON file) ]\n"
+                    "              [ --quiet OR -q (do not print the cycles) ]\n"
+                    "              [ --summary OR -S (print how often each client was on the critical path, needs the server trace-analysis parameter) ]\n"
+    );
+}
+
+/* Index of the client in the client table, 0 being the driver */
+static int get_client(jack_uuid_t uuid)
+{
+    int i;
+    char uuid_str[JACK_UUID_STRING_SIZE];
+    char* name;
+
+    for (i = 0; i < client_count; i++) {
+        if (jack_uuid_compare(clients[i].uuid, uuid) == 0) {
+            return i;
+        }
+    }
+    if (client_count == MAX_TRACED_CLIENTS) {
+        return -1;
+    }
+
+    memset(&clients[client_count], 0, sizeof(traced_client_t));
+    clients[client_count].uuid = uuid;
+    if (jack_uuid_empty(uuid)) {
+        strcpy(clients[client_count].name, "driver");
+    } else {
+        jack_uuid_unparse(uuid, uuid_str);
+        name = jack_get_client_name_by_uuid(client, uuid_str);
+        snprintf(clients[client_count].name, sizeof(clients[client_count].name), "%s", (name) ? name : uuid_str);
+        jack_free(name);
+    }
+
+    if (json) {
+        fprintf(json, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", (json_events++) ? ",\n" : "", client_count);
+        for (name = clients[client_count].name; *name; name++) {
+            if (*name == '"' || *name == '\\') {
+                fputc('\\', json);
+            }
+            fputc(*name, json);
+        }
+        fprintf(json, "\"}}");
+    }
+
+    return client_count++;
+}
+
+static void write_json_slice(const char* name, int tid, jack_time_t begin, jack_time_t end, const jack_trace_event_t* event)
+{
+    if (begin == 0 || end < begin) {
+        return;
+    }
+    if (json_base == 0) {
+        json_base = begin;
+    }
+    fprintf(json, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"args\":{\"cycle\":%u,\"status\":\"%s\",\"slack\":%u,\"critical\":%u}}",
+            (json_events++) ? ",\n" : "",
+            name,
+            tid,
+            (long long)(begin - json_base),
+            (long long)(end - begin),
+            event->cycle,
+            status_names[event->status & 3],
+            event->slack,
+            event->critical);
+}
+
+/* The critical path of a cycle is printed once all its events are read */
+static void print_critical_path()
+{
+    int i;
+
+    if (critical_length == 0) {
+        return;
+    }
+    printf("    critical path :");
+    for (i = 0; i < critical_length; i++) {
+        printf("%s %s", (i > 0) ? " ->" : "", (critical_path[i] >= 0) ? clients[critical_path[i]].name : "?");
+    }
+    printf("\n");
+    critical_length = 0;
+}
+
+static void trace_event(const jack_trace_event_t* event, int quiet)
+{
+    static jack_time_t cycle_begin = 0;
+    int index = get_client(event->client);
+
+    if (jack_uuid_empty(event->client)) {
+        if (!quiet) {
+            print_critical_path();
+        }
+        cycle_begin = event->signaled;
+        if (!quiet) {
+            printf("cycle %u : duration %lld usec, period %lld usec\n",
+                   event->cycle,
+                   (long long)(event->finished - event->signaled),
+                   (long long)event->period_usecs);
+        }
+        if (json && index >= 0) {
+            write_json_slice("cycle", index, event->signaled, event->finished, event);
+        }
+    } else {
+        if (index >= 0 && event->status == JackTraceFinished) {
+            clients[index].cycles++;
+            clients[index].slack_sum += event->slack;
+            if (event->critical > 0) {
+                clients[index].critical_cycles++;
+            }
+        }
+        if (event->critical > 0 && event->critical <= MAX_TRACED_CLIENTS) {
+            critical_path[event->critical - 1] = index;
+            if ((int)event->critical > critical_length) {
+                critical_length = event->critical;
+            }
+        }
+        if (!quiet) {
+            printf("    %-32s signaled %6lld  awake %6lld  finished %6lld  wake latency %5lld  duration %5lld  slack %5u  %s\n",
+                   (index >= 0) ? clients[index].name : "?",
+                   (long long)(event->signaled - cycle_begin),
+                   (long long)(event->awake - cycle_begin),
+                   (long long)(event->finished - cycle_begin),
+                   (long long)(event->awake - event->signaled),
+                   (long long)(event->finished - event->awake),
+                   event->slack,
+                   status_names[event->status & 3]);
+        }
+        if (json && index >= 0) {
+            write_json_slice("wake", index, event->signaled, event->awake, event);
+            write_json_slice("process", index, event->awake, event->finished, event);
+        }
+    }
+}
+
+static void print_summary()
+{
+    int i;
+
+    printf("%-32s %10s %10s %12s\n", "client", "cycles", "critical", "mean slack");
+    for (i = 0; i < client_count; i++) {
+        if (clients[i].cycles > 0) {
+            printf("%-32s %10lu %9.1f%% %7.0f usec\n",
+                   clients[i].name,
+                   clients[i].cycles,
+                   100. * clients[i].critical_cycles / clients[i].cycles,
+                   (double)clients[i].slack_sum / clients[i].cycles);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char* server_name = NULL;
+    const char* json_file = NULL;
+    jack_options_t options = JackNoStartServer;
+    jack_status_t status;
+    jack_trace_event_t events[READ_EVENTS];
+    uint32_t position;
+    uint32_t lost;
+    unsigned long total_lost = 0;
+    int time_to_trace = 0;
+    int quiet = 0;
+    int summary = 0;
+    jack_time_t end = 0;
+    int opt, count, i;
+
+    const char *options_string = "s:t:j:qSh";
+    struct option long_options[] = {
+        {"server", 1, 0, 's'},
+        {"time", 1, 0, 't'},
+        {"json", 1, 0, 'j'},
+        {"quiet", 0, 0, 'q'},
+        {"summary", 0, 0, 'S'},
+        {"help", 0, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, options_string, long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                server_name = optarg;
+                options |= JackServerName;
+                break;
+            case 't':
+                time_to_trace = atoi(optarg);
+                break;
+            case 'j':
+                json_file = optarg;
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            case 'S':
+                summary = 1;
+                break;
+            default:
+                usage();
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    client = jack_client_open("jack_trace", options, &status, server_name);
+    if (client == NULL) {
+        fprintf(stderr, "jack_client_open() failed, status = 0x%2.0x\n", status);
+        return 1;
+    }
+
+    if (json_file) {
+        json = fopen(json_file, "w");
+        if (json == NULL) {
+            fprintf(stderr, "cannot open %s : %s\n", json_file, strerror(errno));
+            jack_client_close(client);
+            return 1;
+        }
+        fprintf(json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"%s\"}}", (server_name) ? server_name : "default");
+        json_events++;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    if (time_to_trace > 0) {
+        end = jack_get_time() + (jack_time_t)time_to_trace * 1000000;
+    }
+
+    position = jack_trace_get_position(client);
+
+    while (running && (end == 0 || jack_get_time() < end)) {
+        count = jack_trace_read(client, &position, events, READ_EVENTS, &lost);
+        if (count < 0) {
+            break;
+        }
+        if (lost > 0) {
+            total_lost += lost;
+            if (!quiet) {
+                printf("%u events lost\n", lost);
+            }
+        }
+        for (i = 0; i < count; i++) {
+            trace_event(&events[i], quiet);
+        }
+        if (count < READ_EVENTS) {
+            usleep(20000);
+        }
+    }
+
+    if (!quiet) {
+        print_critical_path();
+    }
+    if (summary) {
+        print_summary();
+    }
+    if (json) {
+        fprintf(json, "\n]}\n");
+        fclose(json);
+        printf("%d trace events written in %s\n", json_events, json_file);
+    }
+    if (total_lost > 0) {
+        fprintf(stderr, "%lu events lost, the trace ring was not read fast enough\n", total_lost);
+    }
+
+    jack_client_close(client);
+    return 0;
+}
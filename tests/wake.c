@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2026 agent
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/** @file wake.c
+ *
+ * @brief Print the wake-up delay histograms of the driver and of the clients.
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <jack/jack.h>
+#include <jack/statistics.h>
+
+#define MAX_CLIENTS 256
+#define CLIENT_NAME_SIZE 256
+#define BAR_WIDTH 40
+
+static char client_names[MAX_CLIENTS][CLIENT_NAME_SIZE];
+static int client_count = 0;
+
+static void usage()
+{
+    fprintf(stderr, "\n"
+                    "usage: jack_wake_histogram \n"
+                    "              [ --server OR -s server_name ]\n"
+                    "              [ --client OR -c client_name (only print this client, can be repeated) ]\n"
+                    "              [ --driver OR -d (only print the driver) ]\n"
+                    "              [ --interval OR -i seconds (print again every interval) ]\n"
+                    "              [ --reset OR -r (clear the histograms and quit) ]\n"
+    );
+}
+
+static void add_client_name(const char* name, size_t len)
+{
+    int i;
+
+    if (len >= CLIENT_NAME_SIZE || client_count == MAX_CLIENTS) {
+        return;
+    }
+    for (i = 0; i < client_count; i++) {
+        if (strlen(client_names[i]) == len && strncmp(client_names[i], name, len) == 0) {
+            return;
+        }
+    }
+    memcpy(client_names[client_count], name, len);
+    client_names[client_count++][len] = 0;
+}
+
+/* Clients are found from their ports */
+static void find_clients(jack_client_t* client)
+{
+    const char** ports = jack_get_ports(client, NULL, NULL, 0);
+    const char* sep;
+    int i;
+
+    if (ports == NULL) {
+        return;
+    }
+    for (i = 0; ports[i]; i++) {
+        if ((sep = strchr(ports[i], ':')) != NULL) {
+            add_client_name(ports[i], sep - ports[i]);
+        }
+    }
+    jack_free(ports);
+}
+
+static void print_histogram(const char* name, const jack_wake_histogram_t* histogram)
+{
+    uint32_t peak = 0;
+    int first = -1, last = -1;
+    int i;
+
+    printf("%s : %u wake-ups, max %u usec\n", name, histogram->count, histogram->max_usecs);
+
+    for (i = 0; i < JACK_WAKE_HISTOGRAM_BUCKETS; i++) {
+        if (histogram->buckets[i] > 0) {
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+            if (histogram->buckets[i] > peak) {
+                peak = histogram->buckets[i];
+            }
+        }
+    }
+
+    for (i = first; i >= 0 && i <= last; i++) {
+        char range[32];
+        int width = (int)((double)histogram->buckets[i] * BAR_WIDTH / peak + 0.5);
+        if (i == 0) {
+            snprintf(range, sizeof(range), "<= 1");
+        } else if (i == JACK_WAKE_HISTOGRAM_BUCKETS - 1) {
+            snprintf(range, sizeof(range), "> %u", 1u << (i - 1));
+        } else {
+            snprintf(range, sizeof(range), "%u - %u", 1u << (i - 1), 1u << i);
+        }
+        printf("    %17s usec %10u %6.2f%% %.*s\n",
+               range,
+               histogram->buckets[i],
+               100. * histogram->buckets[i] / histogram->count,
+               width,
+               "########################################");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char* server_name = NULL;
+    jack_options_t options = JackNoStartServer;
+    jack_status_t status;
+    jack_client_t* client;
+    jack_wake_histogram_t histogram;
+    int selected_clients = 0;
+    int driver_only = 0;
+    int interval = 0;
+    int reset = 0;
+    int opt, i;
+
+    const char *options_string = "s:c:di:rh";
+    struct option long_options[] = {
+        {"server", 1, 0, 's'},
+        {"client", 1, 0, 'c'},
+        {"driver", 0, 0, 'd'},
+        {"interval", 1, 0, 'i'},
+        {"reset", 0, 0, 'r'},
+        {"help", 0, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, options_string, long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                server_name = optarg;
+                options |= JackServerName;
+                break;
+            case 'c':
+                add_client_name(optarg, strlen(optarg));
+                selected_clients = 1;
+                break;
+            case 'd':
+                driver_only = 1;
+                break;
+            case 'i':
+                interval = atoi(optarg);
+                break;
+            case 'r':
+                reset = 1;
+                break;
+            default:
+                usage();
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    client = jack_client_open("jack_wake_histogram", options, &status, server_name);
+    if (client == NULL) {
+        fprintf(stderr, "jack_client_open() failed, status = 0x%2.0x\n", status);
+        return 1;
+    }
+
+    if (reset) {
+        jack_reset_wake_histograms(client);
+        jack_client_close(client);
+        return 0;
+    }
+
+    do {
+        if (!selected_clients) {
+            if (jack_get_driver_wake_histogram(client, &histogram) == 0) {
+                print_histogram("driver (late)", &histogram);
+            }
+            if (jack_get_driver_early_wake_histogram(client, &histogram) == 0) {
+                print_histogram("driver (early)", &histogram);
+            }
+        }
+        if (!driver_only) {
+            if (!selected_clients) {
+                client_count = 0;
+                find_clients(client);
+            }
+            for (i = 0; i < client_count; i++) {
+                if (jack_client_get_wake_histogram(client, client_names[i], &histogram) == 0) {
+                    print_histogram(client_names[i], &histogram);
+                } else if (selected_clients) {
+                    printf("%s : not an active client\n", client_names[i]);
+                }
+            }
+        }
+        if (interval > 0) {
+            printf("\n");
+            sleep(interval);
+        }
+    } while (interval > 0);
+
+    jack_client_close(client);
+    return 0;
+}
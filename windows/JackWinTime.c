@@ -28,6 +28,14 @@ SERVER_EXPORT void JackSleep(long usec)
 	Sleep(usec / 1000);
 }
 
+SERVER_EXPORT void JackSleepUntil(jack_time_t date_usec)
+{
+	jack_time_t now_usec = GetMicroSeconds();
+	if (date_usec > now_usec) {
+		Sleep((DWORD)((date_usec - now_usec) / 1000));
+	}
+}
+
 SERVER_EXPORT void InitTime()
 {
     TIMECAPS caps;